@@ -0,0 +1,138 @@
+#ifndef ASSETS_HPP
+#define ASSETS_HPP
+
+#include "jobs.h"
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Loads every asset the game needs off the main thread. Files are read and
+// decoded on the job system while the main thread keeps drawing; the only
+// step left to the main thread is the GPU upload of textures, which
+// uploadReady() does as their images come in. Each path is loaded once and
+// asking for it again returns the same asset.
+//
+// Assets are requested before start() and looked up by the returned id
+// afterwards. A missing asset gives nullptr, so callers decide whether to
+// do without it or give up; required ones are listed by missingRequired().
+class AssetCache {
+public:
+    enum class Type {
+        Image,   // decoded pixels, for the atlas packer
+        Texture, // decoded, then uploaded by uploadReady()
+        Font,
+        Sound
+    };
+
+    ~AssetCache() {
+        if (loader.joinable()) loader.join();
+    }
+
+    int request(Type type, const std::string& path, bool required = true) {
+        auto found = byPath.find(path);
+        if (found != byPath.end()) {
+            entries[found->second]->required |= required;
+            return found->second;
+        }
+        auto entry = std::make_unique<Entry>();
+        entry->type = type;
+        entry->path = path;
+        entry->required = required;
+        entries.push_back(std::move(entry));
+        byPath[path] = static_cast<int>(entries.size() - 1);
+        return static_cast<int>(entries.size() - 1);
+    }
+
+    // Loads everything requested so far in the background. The job system
+    // must not be used by anyone else until finished() returns true.
+    void start(JobSystem& jobs) {
+        loader = std::thread([this, &jobs] {
+            jobs.run(entries.size(), [this](size_t i) {
+                Entry& e = *entries[i];
+                e.loaded = e.load();
+                e.done.store(true, std::memory_order_release);
+                completed.fetch_add(1, std::memory_order_release);
+            });
+        });
+    }
+
+    bool finished() const { return completed.load(std::memory_order_acquire) == entries.size(); }
+
+    float progress() const {
+        return entries.empty() ? 1 : completed.load(std::memory_order_acquire) / float(entries.size());
+    }
+
+    // Main thread only: uploads the textures whose images have finished
+    // decoding and frees the decoded copies
+    void uploadReady() {
+        for (auto& entry : entries) {
+            Entry& e = *entry;
+            if (e.type != Type::Texture || e.uploaded || !e.done.load(std::memory_order_acquire)) continue;
+            e.uploaded = true;
+            e.loaded = e.loaded && e.texture.loadFromImage(e.image);
+            e.image = sf::Image();
+        }
+        if (finished() && loader.joinable()) loader.join();
+    }
+
+    const sf::Image* image(int id) const { return ready(id, Type::Image) ? &entries[id]->image : nullptr; }
+    const sf::Font* font(int id) const { return ready(id, Type::Font) ? &entries[id]->font : nullptr; }
+    const sf::SoundBuffer* sound(int id) const { return ready(id, Type::Sound) ? &entries[id]->sound : nullptr; }
+
+    sf::Texture* texture(int id) {
+        return ready(id, Type::Texture) && entries[id]->uploaded ? &entries[id]->texture : nullptr;
+    }
+
+    // Paths of required assets that failed to load
+    std::vector<std::string> missingRequired() const {
+        std::vector<std::string> missing;
+        for (const auto& e : entries) {
+            if (e->required && e->done.load(std::memory_order_acquire) && !e->loaded) missing.push_back(e->path);
+        }
+        return missing;
+    }
+
+private:
+    struct Entry {
+        Type type;
+        std::string path;
+        bool required;
+        bool loaded = false;
+        bool uploaded = false;
+        std::atomic<bool> done{false};
+
+        sf::Image image;
+        sf::Texture texture;
+        sf::Font font;
+        sf::SoundBuffer sound;
+
+        bool load() {
+            switch (type) {
+                case Type::Image:
+                case Type::Texture: return image.loadFromFile(path);
+                case Type::Font: return font.loadFromFile(path);
+                case Type::Sound: return sound.loadFromFile(path);
+            }
+            return false;
+        }
+    };
+
+    // Entries are never moved once requested, so workers can fill them
+    // while the main thread looks at others
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::unordered_map<std::string, int> byPath;
+    std::atomic<size_t> completed{0};
+    std::thread loader;
+
+    bool ready(int id, Type type) const {
+        const Entry& e = *entries[id];
+        return e.type == type && e.done.load(std::memory_order_acquire) && e.loaded;
+    }
+};
+
+#endif // ASSETS_HPP
@@ -0,0 +1,144 @@
+#ifndef ATLAS_HPP
+#define ATLAS_HPP
+
+#include "asteroids.h"
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <memory>
+
+// Packs the frames of every clip into one or two large atlas textures at
+// startup, so all entity sprites can be drawn with very few texture binds.
+// Frames are packed individually onto shelves (the explosion sheets are a
+// single 12k pixel wide row), and all frames of a clip stay on one page.
+// Smoothing is a texture setting, so smoothed and unfiltered clips are
+// packed onto separate pages.
+class TextureAtlas {
+public:
+    explicit TextureAtlas(unsigned pageSize) : pageSize(pageSize) {}
+
+    // Queues every frame of the clip, cut from the sheet it was defined
+    // against, and points the clip at its atlas page. The frame rects are
+    // remapped to the atlas; the sheet must stay alive until build().
+    bool add(AnimationClip& clip, const sf::Image& sheet, bool smooth = false) {
+        size_t page = lastPage(smooth);
+        if (page == pages.size()) page = newPage(smooth);
+
+        std::vector<sf::IntRect> placed;
+        if (!place(pages[page], clip, sheet, placed)) {
+            if (pages[page].placements.empty()) return false;
+            page = newPage(smooth);
+            if (!place(pages[page], clip, sheet, placed)) return false;
+        }
+
+        clip.texture = pages[page].texture.get();
+        clip.frames = placed;
+        return true;
+    }
+
+    // Copies the queued frames into the page images and uploads them
+    bool build() {
+        for (Page& page : pages) {
+            sf::Image image;
+            image.create(pageSize, page.usedHeight(), sf::Color::Transparent);
+            for (const Placement& p : page.placements) {
+                image.copy(*p.sheet, p.dest.left, p.dest.top, p.source);
+            }
+            if (!page.texture->loadFromImage(image)) return false;
+            page.texture->setSmooth(page.smooth);
+            page.placements.clear();
+        }
+        return true;
+    }
+
+private:
+    static constexpr int PADDING = 2;
+
+    struct Placement {
+        const sf::Image* sheet;
+        sf::IntRect source;
+        sf::IntRect dest;
+    };
+
+    struct Page {
+        std::unique_ptr<sf::Texture> texture;
+        std::vector<Placement> placements;
+        unsigned shelfX = 0, shelfY = 0, shelfHeight = 0;
+        bool smooth = false;
+
+        unsigned usedHeight() const { return shelfY + shelfHeight; }
+    };
+
+    unsigned pageSize;
+    std::vector<Page> pages;
+
+    size_t newPage(bool smooth) {
+        Page page;
+        page.texture = std::make_unique<sf::Texture>();
+        page.smooth = smooth;
+        pages.push_back(std::move(page));
+        return pages.size() - 1;
+    }
+
+    // The newest page with the given smoothing, or pages.size() if none
+    size_t lastPage(bool smooth) const {
+        for (size_t i = pages.size(); i-- > 0;) {
+            if (pages[i].smooth == smooth) return i;
+        }
+        return pages.size();
+    }
+
+    // Places all frames of the clip on the page, or leaves the page
+    // untouched and returns false if they do not all fit
+    bool place(Page& page, const AnimationClip& clip, const sf::Image& sheet,
+               std::vector<sf::IntRect>& placed) {
+        Page trial;
+        trial.shelfX = page.shelfX;
+        trial.shelfY = page.shelfY;
+        trial.shelfHeight = page.shelfHeight;
+        std::vector<Placement> added;
+        placed.clear();
+
+        for (const sf::IntRect& source : clip.frames) {
+            // Frames shared with an earlier clip (the boss rock reuses the
+            // rock sheet) are stored once
+            if (const Placement* existing = find(page, sheet, source)) {
+                placed.push_back(existing->dest);
+                continue;
+            }
+
+            unsigned w = source.width + PADDING;
+            unsigned h = source.height + PADDING;
+            if (w > pageSize) return false;
+            if (trial.shelfX + w > pageSize) {
+                trial.shelfY += trial.shelfHeight;
+                trial.shelfX = 0;
+                trial.shelfHeight = 0;
+            }
+            if (trial.shelfY + h > pageSize) return false;
+
+            sf::IntRect dest(trial.shelfX, trial.shelfY, source.width, source.height);
+            added.push_back({&sheet, source, dest});
+            placed.push_back(dest);
+            trial.shelfX += w;
+            trial.shelfHeight = std::max(trial.shelfHeight, h);
+        }
+
+        page.shelfX = trial.shelfX;
+        page.shelfY = trial.shelfY;
+        page.shelfHeight = trial.shelfHeight;
+        page.placements.insert(page.placements.end(), added.begin(), added.end());
+        return true;
+    }
+
+    static const Placement* find(const Page& page, const sf::Image& sheet, const sf::IntRect& source) {
+        for (const Placement& p : page.placements) {
+            if (p.sheet == &sheet && p.source.left == source.left && p.source.top == source.top &&
+                p.source.width == source.width && p.source.height == source.height) {
+                return &p;
+            }
+        }
+        return nullptr;
+    }
+};
+
+#endif // ATLAS_HPP
@@ -0,0 +1,113 @@
+#ifndef AUDIO_HPP
+#define AUDIO_HPP
+
+#include "world.h"
+#include <SFML/Audio.hpp>
+#include <cstdint>
+
+// Plays the simulation's sound cues on a fixed pool of voices, so rapid
+// fire overlaps instead of restarting one sound. When every voice is busy a
+// new cue takes over the oldest voice of the lowest priority, if that is no
+// higher than its own; otherwise the cue is dropped. Music and effects have
+// separate volumes. Main thread only, apart from the queue, which the
+// simulation thread fills.
+class AudioMixer {
+public:
+    static constexpr int VOICE_COUNT = 16;
+
+    enum class Category {
+        Music,
+        Effects,
+        Count
+    };
+
+    SoundQueue cues;
+
+    // A cue without a buffer stays silent
+    void setCue(SoundId id, const sf::SoundBuffer* buffer, int priority, float pitch = 1) {
+        CueSound& cue = cueSounds[static_cast<int>(id)];
+        cue.buffer = buffer;
+        cue.priority = priority;
+        cue.pitch = pitch;
+    }
+
+    // Music streams follow the music volume from now on
+    void addMusic(sf::Music& music) {
+        if (musicCount < MAX_MUSIC) this->music[musicCount++] = &music;
+        music.setVolume(categoryVolume[static_cast<int>(Category::Music)]);
+    }
+
+    // volume is 0-100, as in SFML
+    void setVolume(Category category, float volume) {
+        categoryVolume[static_cast<int>(category)] = volume;
+        if (category == Category::Music) {
+            for (int i = 0; i < musicCount; i++) music[i]->setVolume(volume);
+        } else {
+            for (Voice& v : voices) v.sound.setVolume(volume);
+        }
+    }
+
+    // Plays every cue queued since the last call
+    void update() {
+        SoundId id;
+        while (cues.pop(id)) play(id);
+    }
+
+    void play(SoundId id) {
+        const CueSound& cue = cueSounds[static_cast<int>(id)];
+        if (!cue.buffer) return;
+
+        Voice* voice = pickVoice(cue.priority);
+        if (!voice) return;
+        voice->sound.stop();
+        voice->sound.setBuffer(*cue.buffer);
+        voice->sound.setPitch(cue.pitch);
+        voice->sound.setVolume(categoryVolume[static_cast<int>(Category::Effects)]);
+        voice->sound.play();
+        voice->priority = cue.priority;
+        voice->startedAt = ++played;
+    }
+
+    void stopAll() {
+        for (Voice& v : voices) v.sound.stop();
+    }
+
+private:
+    static constexpr int MAX_MUSIC = 4;
+
+    struct CueSound {
+        const sf::SoundBuffer* buffer = nullptr;
+        int priority = 0;
+        float pitch = 1;
+    };
+
+    struct Voice {
+        sf::Sound sound;
+        int priority = 0;
+        uint64_t startedAt = 0;
+    };
+
+    CueSound cueSounds[SOUND_COUNT];
+    Voice voices[VOICE_COUNT];
+    sf::Music* music[MAX_MUSIC] = {};
+    int musicCount = 0;
+    float categoryVolume[static_cast<int>(Category::Count)] = {100, 100};
+    uint64_t played = 0;
+
+    // A free voice, else the oldest of the lowest priority at or below
+    // priority, else nullptr
+    Voice* pickVoice(int priority) {
+        Voice* victim = nullptr;
+        for (Voice& v : voices) {
+            if (v.sound.getStatus() == sf::Sound::Stopped) return &v;
+            if (v.priority > priority) continue;
+            if (!victim || v.priority < victim->priority ||
+                (v.priority == victim->priority && v.startedAt < victim->startedAt)) {
+                victim = &v;
+            }
+        }
+        return victim;
+    }
+};
+
+#endif // AUDIO_HPP
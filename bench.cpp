@@ -0,0 +1,175 @@
+// Times each phase of World::step() at increasing entity densities.
+//
+//   g++ -O2 -std=c++17 -pthread bench.cpp -o bench
+//   ./bench [ticks] [--threads n] [--json results.json]
+//
+// Prints a table of mean/p50/p99/max microseconds per phase for every
+// scenario. Denser scenarios run fewer ticks by default; passing ticks runs
+// every scenario for that many. --threads defaults to one per core;
+// --threads 1 runs without the job system. With --json the same numbers are also written as one JSON
+// document, for comparing runs across commits.
+
+#include "world.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+struct Scenario {
+    const char* name;
+    int asteroids;
+    int bullets;
+    int bosses;
+    int ticks;
+};
+
+const Scenario SCENARIOS[] = {
+    {"15", INITIAL_ASTEROIDS, 2, 0, 1200},
+    {"500", 450, 50, 2, 1200},
+    {"5k", 4500, 500, MAX_BOSS_ASTEROIDS, 300},
+    {"50k", 45000, 5000, MAX_BOSS_ASTEROIDS, 30},
+};
+
+struct PhaseStats {
+    double mean, p50, p99, max;
+};
+
+struct Result {
+    const Scenario* scenario;
+    int ticks;
+    PhaseStats phases[PHASE_COUNT];
+    PhaseStats total;
+};
+
+// Fills the world without a player, so nothing resets it mid-run. Bullets
+// start anywhere with random headings and expire as usual.
+void populate(World& world, const Scenario& s) {
+    world.clear();
+    int rocks = 0;
+    for (; rocks + INITIAL_ASTEROIDS <= s.asteroids; rocks += INITIAL_ASTEROIDS) {
+        world.spawnInitialAsteroids();
+    }
+    for (; rocks < s.asteroids; rocks++) {
+        float x = world.rng.below(W);
+        float y = world.rng.below(H);
+        world.spawnAsteroid(ClipId::Rock, x, y, world.rng.below(360), 25);
+    }
+    for (int i = 0; i < s.bosses; i++) {
+        world.spawnBossAsteroid();
+    }
+    for (int i = 0; i < s.bullets; i++) {
+        float x = world.rng.below(W);
+        float y = world.rng.below(H);
+        world.spawnBullet(ClipId::Bullet, x, y, world.rng.below(360));
+    }
+}
+
+PhaseStats summarize(std::vector<double>& samples) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double v : samples) sum += v;
+    auto at = [&](double q) { return samples[std::min(samples.size() - 1, size_t(q * samples.size()))]; };
+    return {sum / samples.size(), at(0.5), at(0.99), samples.back()};
+}
+
+Result run(const Scenario& s, int ticks, JobSystem* jobs) {
+    using Clock = std::chrono::steady_clock;
+
+    World world;
+    world.jobs = jobs;
+    populate(world, s);
+
+    std::vector<double> samples[PHASE_COUNT];
+    std::vector<double> totals;
+    for (auto& v : samples) v.reserve(ticks);
+    totals.reserve(ticks);
+
+    Input idle;
+    for (int tick = 0; tick < ticks; tick++) {
+        double total = 0;
+        world.step(idle, [&](Phase phase, auto&& phaseBody) {
+            auto start = Clock::now();
+            phaseBody();
+            double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            samples[static_cast<int>(phase)].push_back(us);
+            total += us;
+        });
+        totals.push_back(total);
+    }
+
+    Result r;
+    r.scenario = &s;
+    r.ticks = ticks;
+    for (int p = 0; p < PHASE_COUNT; p++) r.phases[p] = summarize(samples[p]);
+    r.total = summarize(totals);
+    return r;
+}
+
+void printRow(const char* name, const PhaseStats& st) {
+    printf("  %-8s %10.1f %10.1f %10.1f %10.1f\n", name, st.mean, st.p50, st.p99, st.max);
+}
+
+void writeStats(FILE* f, const char* name, const PhaseStats& st, bool last) {
+    fprintf(f, "        \"%s\": {\"mean\": %.3f, \"p50\": %.3f, \"p99\": %.3f, \"max\": %.3f}%s\n",
+            name, st.mean, st.p50, st.p99, st.max, last ? "" : ",");
+}
+
+bool writeJson(const char* path, unsigned threads, const std::vector<Result>& results) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "{\n  \"unit\": \"us\",\n  \"threads\": %u,\n  \"scenarios\": [\n", threads);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(f, "    {\n      \"name\": \"%s\",\n      \"asteroids\": %d,\n      \"bullets\": %d,\n"
+                   "      \"bosses\": %d,\n      \"ticks\": %d,\n      \"phases\": {\n",
+                r.scenario->name, r.scenario->asteroids, r.scenario->bullets, r.scenario->bosses, r.ticks);
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            writeStats(f, phaseName(static_cast<Phase>(p)), r.phases[p], false);
+        }
+        writeStats(f, "total", r.total, true);
+        fprintf(f, "      }\n    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+int main(int argc, char** argv) {
+    int ticks = 0;
+    unsigned threads = JobSystem::defaultWorkers() + 1;
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1, atoi(argv[++i]));
+        } else {
+            ticks = std::max(1, atoi(argv[i]));
+        }
+    }
+
+    std::unique_ptr<JobSystem> jobs;
+    if (threads > 1) jobs = std::make_unique<JobSystem>(threads - 1);
+
+    std::vector<Result> results;
+    for (const Scenario& s : SCENARIOS) {
+        Result r = run(s, ticks > 0 ? ticks : s.ticks, jobs.get());
+        results.push_back(r);
+
+        printf("%s: %d asteroids, %d bullets, %d bosses, %d ticks, %u threads (us per tick)\n",
+               s.name, s.asteroids, s.bullets, s.bosses, r.ticks, threads);
+        printf("  %-8s %10s %10s %10s %10s\n", "phase", "mean", "p50", "p99", "max");
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            printRow(phaseName(static_cast<Phase>(p)), r.phases[p]);
+        }
+        printRow("total", r.total);
+    }
+
+    if (jsonPath && !writeJson(jsonPath, threads, results)) {
+        fprintf(stderr, "Failed to write %s\n", jsonPath);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,91 @@
+// Compares the scalar isCollide() with overlapMask8()/overlapMask16() on
+// one circle against packed candidate circles.
+//
+//   g++ -O2 -std=c++17 bench_narrowphase.cpp -o bench_narrowphase
+//   g++ -O2 -mavx2 -std=c++17 bench_narrowphase.cpp -o bench_narrowphase
+//   ./bench_narrowphase [rounds]
+
+#include "world.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+constexpr int CANDIDATES = 1024;
+constexpr int SHOOTERS = 256;
+
+template <typename F>
+double nanosPerTest(int rounds, unsigned& sink, F&& testAll) {
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) sink += testAll();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / (double(rounds) * SHOOTERS * CANDIDATES);
+}
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? std::max(1, atoi(argv[1])) : 200;
+
+    // Candidates as rocks in their own arrays, shooters as bullets
+    srand(1);
+    EntityArrays rocks(EntityKind::Asteroid);
+    EntityArrays shots(EntityKind::Bullet);
+    for (int i = 0; i < CANDIDATES; i++) {
+        rocks.add(ClipId::Rock, rand() % W, rand() % H, 0, 25);
+    }
+    for (int i = 0; i < SHOOTERS; i++) {
+        shots.add(ClipId::Bullet, rand() % W, rand() % H, 0, 10);
+    }
+    const float* xs = rocks.x.data();
+    const float* ys = rocks.y.data();
+    const float* rs = rocks.R.data();
+
+    unsigned sink = 0;
+    unsigned scalarHits = 0, simdHits = 0;
+
+    double scalar = nanosPerTest(rounds, sink, [&] {
+        unsigned hits = 0;
+        for (size_t s = 0; s < shots.size(); s++) {
+            for (size_t k = 0; k < rocks.size(); k++) hits += isCollide(shots, s, rocks, k);
+        }
+        scalarHits = hits;
+        return hits;
+    });
+
+    double lanes8 = nanosPerTest(rounds, sink, [&] {
+        unsigned hits = 0;
+        for (size_t s = 0; s < shots.size(); s++) {
+            for (int k = 0; k < CANDIDATES; k += 8) {
+                hits += __builtin_popcount(overlapMask8(shots.x[s], shots.y[s], shots.R[s], xs + k, ys + k, rs + k));
+            }
+        }
+        simdHits = hits;
+        return hits;
+    });
+
+    double lanes16 = nanosPerTest(rounds, sink, [&] {
+        unsigned hits = 0;
+        for (size_t s = 0; s < shots.size(); s++) {
+            for (int k = 0; k < CANDIDATES; k += 16) {
+                hits += __builtin_popcount(overlapMask16(shots.x[s], shots.y[s], shots.R[s], xs + k, ys + k, rs + k));
+            }
+        }
+        return hits;
+    });
+
+#if defined(__AVX__)
+    const char* isa = "AVX";
+#elif defined(__SSE2__)
+    const char* isa = "SSE2";
+#else
+    const char* isa = "scalar";
+#endif
+    printf("%d x %d circle tests, %d rounds, %s build\n", SHOOTERS, CANDIDATES, rounds, isa);
+    printf("  isCollide      %6.3f ns/test\n", scalar);
+    printf("  overlapMask8   %6.3f ns/test  (%.1fx)\n", lanes8, scalar / lanes8);
+    printf("  overlapMask16  %6.3f ns/test  (%.1fx)\n", lanes16, scalar / lanes16);
+    if (scalarHits != simdHits) {
+        printf("MISMATCH: %u scalar hits, %u SIMD hits\n", scalarHits, simdHits);
+        return EXIT_FAILURE;
+    }
+    printf("  %u hits per round, identical (checksum %u)\n", scalarHits, sink);
+    return EXIT_SUCCESS;
+}
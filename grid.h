@@ -0,0 +1,249 @@
+#ifndef GRID_HPP
+#define GRID_HPP
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Uniform grid broadphase over the playfield. Rebuilt every tick: insert()
+// each collidable circle, build(), then forEachCellRun() hands out the
+// circles near a query circle cell by cell. Like isCollide(), collisions
+// are planar: nothing meets across the screen edges, and circles past an
+// edge are binned into the edge cells.
+class CollisionGrid {
+public:
+    // Entries readable past the end of every forEachCellRun() run
+    static constexpr int RUN_PADDING = 16;
+
+    CollisionGrid(int width, int height, int cellSize)
+        : cellSize(static_cast<float>(cellSize)),
+          cols(std::max(1, width / cellSize)),
+          rows(std::max(1, height / cellSize)),
+          cellStart(cols * rows + 1, 0) {}
+
+    void clear() {
+        items.clear();
+    }
+
+    // Returns the index later passed to the forEachCellRun() callbacks
+    int insert(float x, float y, float r) {
+        items.push_back(cover(x, y, r));
+        return static_cast<int>(items.size()) - 1;
+    }
+
+    void build() {
+        // Counting sort of (cell, item) entries into one flat array
+        std::fill(cellStart.begin(), cellStart.end(), 0);
+        for (const Item& it : items) {
+            forEachCell(it, [&](int cell) { cellStart[cell + 1]++; });
+        }
+        for (size_t c = 1; c < cellStart.size(); c++) {
+            cellStart[c] += cellStart[c - 1];
+        }
+
+        cellItems.resize(cellStart.back());
+        cursor.assign(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < static_cast<int>(items.size()); i++) {
+            forEachCell(items[i], [&](int cell) { cellItems[cursor[cell]++] = i; });
+        }
+
+        // Circles again in cell order, so each cell's run is contiguous
+        size_t packed = cellItems.size() + RUN_PADDING;
+        cellX.resize(packed);
+        cellY.resize(packed);
+        cellR.resize(packed);
+        for (size_t k = 0; k < cellItems.size(); k++) {
+            const Item& it = items[cellItems[k]];
+            cellX[k] = it.x;
+            cellY[k] = it.y;
+            cellR[k] = it.r;
+        }
+    }
+
+    // Calls f(items, xs, ys, rs, count) for every cell the circle overlaps,
+    // with the indices, positions and radii of the circles binned there.
+    // An item spanning several of those cells is reported once per cell.
+    template <typename F>
+    void forEachCellRun(float x, float y, float r, F&& f) const {
+        forEachCell(cover(x, y, r), [&](int cell) {
+            int start = cellStart[cell];
+            int count = cellStart[cell + 1] - start;
+            if (count > 0) {
+                f(&cellItems[start], &cellX[start], &cellY[start], &cellR[start], count);
+            }
+        });
+    }
+
+private:
+    struct Item {
+        int x0, x1, y0, y1; // cell range covered by the circle, clamped to the grid
+        float x, y, r;
+    };
+
+    float cellSize;
+    int cols, rows;
+    std::vector<Item> items;
+    std::vector<int> cellStart;
+    std::vector<int> cellItems;
+    std::vector<float> cellX, cellY, cellR;
+    std::vector<int> cursor;
+
+    int clampCell(float v, int n) const {
+        int c = static_cast<int>(std::floor(v / cellSize));
+        return std::max(0, std::min(c, n - 1));
+    }
+
+    Item cover(float x, float y, float r) const {
+        Item it;
+        it.x0 = clampCell(x - r, cols);
+        it.x1 = clampCell(x + r, cols);
+        it.y0 = clampCell(y - r, rows);
+        it.y1 = clampCell(y + r, rows);
+        it.x = x;
+        it.y = y;
+        it.r = r;
+        return it;
+    }
+
+    template <typename F>
+    void forEachCell(const Item& it, F&& f) const {
+        for (int cy = it.y0; cy <= it.y1; cy++) {
+            int row = cy * cols;
+            for (int cx = it.x0; cx <= it.x1; cx++) {
+                f(row + cx);
+            }
+        }
+    }
+};
+
+// Points binned into a uniform grid over the playfield for nearest-point
+// and radius queries. Distances are plain planar ones, as in CollisionGrid,
+// which is what a bullet that dies at the screen edge sees.
+// Usage mirrors CollisionGrid: clear(), insert() every point, build().
+class PointGrid {
+public:
+    PointGrid(int width, int height, int cellSize)
+        : cellSize(static_cast<float>(cellSize)),
+          cols(std::max(1, width / cellSize)),
+          rows(std::max(1, height / cellSize)),
+          cellStart(cols * rows + 1, 0) {}
+
+    void clear() {
+        points.clear();
+    }
+
+    // Returns the index later passed to query callbacks
+    int insert(float x, float y) {
+        points.push_back({x, y, cellOf(x, y)});
+        return static_cast<int>(points.size()) - 1;
+    }
+
+    void build() {
+        std::fill(cellStart.begin(), cellStart.end(), 0);
+        for (const Point& p : points) cellStart[p.cell + 1]++;
+        for (size_t c = 1; c < cellStart.size(); c++) {
+            cellStart[c] += cellStart[c - 1];
+        }
+
+        cellItems.resize(points.size());
+        cursor.assign(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < static_cast<int>(points.size()); i++) {
+            cellItems[cursor[points[i].cell]++] = i;
+        }
+    }
+
+    // Index of the point closest to (x, y) among those accept(index) allows,
+    // or -1. Searches square rings of cells outwards and stops once no
+    // further ring can hold anything closer, so the cost depends on the
+    // local density rather than on the number of points.
+    template <typename Accept>
+    int nearest(float x, float y, Accept&& accept) const {
+        int cx = clampCell(x, cols);
+        int cy = clampCell(y, rows);
+        int best = -1;
+        float bestDist = 0;
+
+        int maxRing = std::max(cols, rows);
+        for (int ring = 0; ring <= maxRing; ring++) {
+            forEachRingCell(cx, cy, ring, [&](int cell) {
+                for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                    int i = cellItems[k];
+                    float ex = points[i].x - x;
+                    float ey = points[i].y - y;
+                    float dist = ex * ex + ey * ey;
+                    if ((best < 0 || dist < bestDist) && accept(i)) {
+                        best = i;
+                        bestDist = dist;
+                    }
+                }
+            });
+
+            // Cells of the next ring are at least ring cells away
+            float reach = ring * cellSize;
+            if (best >= 0 && bestDist <= reach * reach) break;
+        }
+        return best;
+    }
+
+    // Calls f(index, distanceSquared) for every point within radius of (x, y)
+    template <typename F>
+    void forEachWithin(float x, float y, float radius, F&& f) const {
+        int x0 = clampCell(x - radius, cols), x1 = clampCell(x + radius, cols);
+        int y0 = clampCell(y - radius, rows), y1 = clampCell(y + radius, rows);
+        float radiusSq = radius * radius;
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                int cell = cy * cols + cx;
+                for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                    int i = cellItems[k];
+                    float ex = points[i].x - x;
+                    float ey = points[i].y - y;
+                    float dist = ex * ex + ey * ey;
+                    if (dist <= radiusSq) f(i, dist);
+                }
+            }
+        }
+    }
+
+private:
+    struct Point {
+        float x, y;
+        int cell;
+    };
+
+    float cellSize;
+    int cols, rows;
+    std::vector<Point> points;
+    std::vector<int> cellStart;
+    std::vector<int> cellItems;
+    std::vector<int> cursor;
+
+    int clampCell(float v, int n) const {
+        int c = static_cast<int>(std::floor(v / cellSize));
+        return std::max(0, std::min(c, n - 1));
+    }
+
+    int cellOf(float x, float y) const {
+        return clampCell(y, rows) * cols + clampCell(x, cols);
+    }
+
+    // Visits the cells at Chebyshev distance ring from (cx, cy) that lie
+    // inside the grid
+    template <typename F>
+    void forEachRingCell(int cx, int cy, int ring, F&& f) const {
+        if (ring == 0) {
+            f(cy * cols + cx);
+            return;
+        }
+        for (int y = cy - ring; y <= cy + ring; y++) {
+            if (y < 0 || y >= rows) continue;
+            bool edgeRow = y == cy - ring || y == cy + ring;
+            int step = edgeRow ? 1 : 2 * ring;
+            for (int x = cx - ring; x <= cx + ring; x += step) {
+                if (x >= 0 && x < cols) f(y * cols + x);
+            }
+        }
+    }
+};
+
+#endif // GRID_HPP
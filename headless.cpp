@@ -0,0 +1,131 @@
+// Runs the simulation without a window, textures or audio, as fast as it
+// will go. Useful for soak tests, for checking that a seed replays the
+// same game whatever the thread count, and for replaying recorded games as
+// repeatable performance runs.
+//
+//   g++ -O2 -std=c++17 -pthread headless.cpp -o headless
+//   ./headless [ticks] [seed] [threads] [--record file] [--replay file] [--hash-every n]
+//              [--load file] [--save file]
+//
+// --record saves the scripted input as a replay. --replay plays back a log
+// written by --record or by the game's --record instead, using its seed and
+// length. --hash-every prints World::stateHash() every n ticks, so two runs
+// can be diffed. --load starts from a save state (the game's F5 writes
+// quicksave.bin) instead of a new round, and --save writes one at the end.
+// Input logs only start from a seed, so --load cannot be combined with
+// --record or --replay.
+
+#include "world.h"
+#include "replay.h"
+#include "savestate.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+// Stand-in pilot: circles while firing, toggles thrust every two seconds
+// and launches a homing missile every 1.5 seconds
+Input scriptedInput(long tick) {
+    Input input;
+    input.turnRight = true;
+    input.fire = true;
+    input.thrust = (tick / 120) % 2 == 1;
+    input.fireHoming = tick % 90 == 0;
+    return input;
+}
+
+int main(int argc, char** argv) {
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    const char* loadPath = nullptr;
+    const char* savePath = nullptr;
+    long hashEvery = 0;
+    const char* positional[3] = {};
+    int positionalCount = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            loadPath = argv[++i];
+        } else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            savePath = argv[++i];
+        } else if (strcmp(argv[i], "--hash-every") == 0 && i + 1 < argc) {
+            hashEvery = atol(argv[++i]);
+        } else if (positionalCount < 3) {
+            positional[positionalCount++] = argv[i];
+        }
+    }
+
+    if (loadPath && (recordPath || replayPath)) {
+        fprintf(stderr, "--load cannot be combined with --record or --replay\n");
+        return EXIT_FAILURE;
+    }
+
+    long ticks = positional[0] ? atol(positional[0]) : TICK_RATE * 60 * 10;
+    uint64_t seed = positional[1] ? strtoull(positional[1], nullptr, 10) : 1;
+    unsigned threads = positional[2] ? static_cast<unsigned>(atol(positional[2])) : JobSystem::defaultWorkers() + 1;
+
+    InputLog log;
+    if (replayPath) {
+        if (!log.load(replayPath)) {
+            fprintf(stderr, "Failed to read replay %s\n", replayPath);
+            return EXIT_FAILURE;
+        }
+        seed = log.seed;
+        ticks = static_cast<long>(log.tickCount());
+    }
+    InputLog::Reader replay(log);
+
+    static World world;
+    std::unique_ptr<JobSystem> jobs;
+    if (threads > 1) {
+        jobs = std::make_unique<JobSystem>(threads - 1);
+        world.jobs = jobs.get();
+    }
+    world.rng.seed(seed);
+    world.reset();
+    if (loadPath && !loadWorldFile(world, loadPath)) {
+        fprintf(stderr, "Failed to load %s\n", loadPath);
+        return EXIT_FAILURE;
+    }
+
+    InputLog recording;
+    if (recordPath) recording.start(seed);
+
+    auto start = std::chrono::steady_clock::now();
+    for (long tick = 0; tick < ticks; tick++) {
+        Input input = scriptedInput(tick);
+        if (replayPath) replay.next(input);
+        if (recordPath) recording.append(input);
+        world.step(input);
+        if (hashEvery > 0 && (tick + 1) % hashEvery == 0) {
+            printf("tick %-8ld hash %016llx\n", tick + 1, (unsigned long long)world.stateHash());
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("ticks:       %ld (%.1f s of game time), %u threads\n", ticks, ticks * TICK_DT, threads > 1 ? threads : 1);
+    printf("wall time:   %.3f s, %.0f ticks/s, %.1fx realtime\n",
+           seconds, ticks / seconds, ticks * TICK_DT / seconds);
+    printf("score:       %d (high %d)\n", world.score(), world.maxAsteroidsDestroyed);
+    printf("entities:    %zu asteroids, %zu bosses, %zu bullets, %zu homing, %zu explosions, %zu effects\n",
+           world.asteroids.size(), world.bosses.size(), world.bullets.size(),
+           world.homing.size(), world.explosions.size(), world.effects.size());
+    printf("state hash:  %016llx\n", (unsigned long long)world.stateHash());
+    if (world.poolGrowths() > 0) {
+        printf("pool growths: %d\n", world.poolGrowths());
+    }
+
+    if (savePath && !saveWorldFile(world, savePath)) {
+        fprintf(stderr, "Failed to save %s\n", savePath);
+        return EXIT_FAILURE;
+    }
+    if (recordPath && !recording.save(recordPath)) {
+        fprintf(stderr, "Failed to write replay %s\n", recordPath);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
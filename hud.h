@@ -0,0 +1,246 @@
+#ifndef HUD_HPP
+#define HUD_HPP
+
+#include "asteroids.h"
+#include "profiler.h"
+#include "scores.h"
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+// Label plus number that only re-lays-out its text when the number changes
+class CounterText {
+public:
+    void init(const sf::Font& font, const std::string& labelText, unsigned characterSize,
+              sf::Vector2f position) {
+        label = labelText;
+        text.setFont(font);
+        text.setCharacterSize(characterSize);
+        text.setPosition(position);
+        text.setFillColor(sf::Color::White);
+        shown = -1;
+        set(0);
+    }
+
+    void set(int value) {
+        if (value == shown) return;
+        shown = value;
+        text.setString(label + std::to_string(value));
+    }
+
+    void draw(sf::RenderTarget& target) const {
+        target.draw(text);
+    }
+
+private:
+    std::string label;
+    sf::Text text;
+    int shown = -1;
+};
+
+// Health bars of every boss in one vertex array. The "BOSS HP" labels are
+// laid out once per possible health value and only moved when drawn.
+class BossHealthBars {
+public:
+    void init(const sf::Font& font) {
+        for (int hp = 0; hp <= BOSS_MAX_HEALTH; hp++) {
+            sf::Text& label = labels[hp];
+            label.setString("BOSS HP: " + std::to_string(hp));
+            label.setFont(font);
+            label.setCharacterSize(24);
+            label.setFillColor(sf::Color::Red);
+        }
+    }
+
+    void begin() {
+        bars.clear();
+        count = 0;
+    }
+
+    void add(float x, float y, int health) {
+        health = std::max(0, std::min(health, BOSS_MAX_HEALTH));
+        if (count < MAX_LABELS) {
+            placed[count++] = {x - 50, y - 60, health};
+        }
+
+        float healthPercentage = static_cast<float>(health) / BOSS_MAX_HEALTH;
+        addQuad(x - 50, y - 40, 100, 10, sf::Color(50, 50, 50));
+        addQuad(x - 50, y - 40, 100 * healthPercentage, 10, sf::Color::Red);
+    }
+
+    void draw(sf::RenderTarget& target) {
+        target.draw(bars);
+        for (int i = 0; i < count; i++) {
+            sf::Text& label = labels[placed[i].health];
+            label.setPosition(placed[i].x, placed[i].y);
+            target.draw(label);
+        }
+    }
+
+private:
+    static constexpr int MAX_LABELS = BOSS_CAPACITY;
+
+    struct PlacedLabel {
+        float x, y;
+        int health;
+    };
+
+    sf::VertexArray bars{sf::Quads};
+    sf::Text labels[BOSS_MAX_HEALTH + 1];
+    PlacedLabel placed[MAX_LABELS];
+    int count = 0;
+
+    void addQuad(float x, float y, float w, float h, sf::Color color) {
+        bars.append(sf::Vertex(sf::Vector2f(x, y), color));
+        bars.append(sf::Vertex(sf::Vector2f(x + w, y), color));
+        bars.append(sf::Vertex(sf::Vector2f(x + w, y + h), color));
+        bars.append(sf::Vertex(sf::Vector2f(x, y + h), color));
+    }
+};
+
+// In-game overlay. Built once when the font is loaded; per frame only the
+// values change.
+class Hud {
+public:
+    CounterText score;
+    CounterText highScore;
+    BossHealthBars bossBars;
+
+    void init(const sf::Font& font) {
+        score.init(font, "Score: ", 24, sf::Vector2f(20, 20));
+        highScore.init(font, "High Score: ", 24, sf::Vector2f(20, 50));
+        bossBars.init(font);
+
+        pauseButton.setSize(sf::Vector2f(120, 50));
+        pauseButton.setPosition(W - 140, 20);
+        pauseButton.setFillColor(sf::Color(70, 70, 70, 220));
+        pauseButton.setOutlineThickness(2);
+        pauseButton.setOutlineColor(sf::Color::White);
+
+        pauseLabel.setString("PAUSE");
+        pauseLabel.setFont(font);
+        pauseLabel.setCharacterSize(24);
+        pauseLabel.setPosition(W - 120, 30);
+        pauseLabel.setFillColor(sf::Color::White);
+    }
+
+    void drawScores(sf::RenderTarget& target) const {
+        score.draw(target);
+        highScore.draw(target);
+    }
+
+    void drawPauseButton(sf::RenderTarget& target) const {
+        target.draw(pauseButton);
+        target.draw(pauseLabel);
+    }
+
+private:
+    sf::RectangleShape pauseButton;
+    sf::Text pauseLabel;
+};
+
+// Best scores of all runs, for the main menu. The text is only rebuilt when
+// the store hands over a new list.
+class Leaderboard {
+public:
+    static constexpr size_t SHOWN = 5;
+
+    void init(const sf::Font& font) {
+        text.setFont(font);
+        text.setCharacterSize(22);
+        text.setFillColor(sf::Color(200, 200, 200));
+        set({});
+    }
+
+    void set(const std::vector<ScoreEntry>& scores) {
+        std::string lines = "HIGH SCORES\n";
+        char line[64];
+        for (size_t i = 0; i < std::min(scores.size(), SHOWN); i++) {
+            time_t when = static_cast<time_t>(scores[i].time);
+            char date[16] = "";
+            if (const tm* local = localtime(&when)) strftime(date, sizeof date, "%Y-%m-%d", local);
+            snprintf(line, sizeof line, "%zu.  %5d   %s\n", i + 1, scores[i].score, date);
+            lines += line;
+        }
+        if (scores.empty()) lines += "none yet\n";
+        text.setString(lines);
+        text.setPosition(W/2 - text.getLocalBounds().width/2, H/2 + 140);
+    }
+
+    void draw(sf::RenderTarget& target) const {
+        target.draw(text);
+    }
+
+private:
+    sf::Text text;
+};
+
+// Profiler readout in the top right corner: each zone of the last frame
+// averaged over AVERAGE_FRAMES, then the counters. The text is rebuilt only
+// every REFRESH_FRAMES frames so the overlay barely shows up in itself.
+class ProfilerOverlay {
+public:
+    bool visible = false;
+
+    void init(const sf::Font& font) {
+        text.setFont(font);
+        text.setCharacterSize(16);
+        text.setFillColor(sf::Color::White);
+        background.setFillColor(sf::Color(0, 0, 0, 170));
+    }
+
+    void toggle() {
+        visible = !visible;
+        sinceRefresh = REFRESH_FRAMES;
+    }
+
+    void draw(sf::RenderTarget& target, const Profiler& profiler) {
+        if (!visible) return;
+        if (++sinceRefresh >= REFRESH_FRAMES && profiler.frameCount() > 0) {
+            sinceRefresh = 0;
+            rebuild(profiler);
+        }
+        target.draw(background);
+        target.draw(text);
+    }
+
+private:
+    static constexpr int AVERAGE_FRAMES = 60;
+    static constexpr int REFRESH_FRAMES = 30;
+
+    sf::Text text;
+    sf::RectangleShape background;
+    std::string lines;
+    int sinceRefresh = 0;
+
+    void rebuild(const Profiler& profiler) {
+        char line[96];
+        lines.clear();
+        snprintf(line, sizeof line, "frame  %6.2f ms\n", profiler.averageFrameMs(AVERAGE_FRAMES));
+        lines += line;
+
+        const Profiler::Frame& frame = profiler.frame(0);
+        for (int i = 0; i < frame.zoneCount; i++) {
+            const Profiler::Zone& zone = frame.zones[i];
+            snprintf(line, sizeof line, "%*s%-12s %6.2f ms\n", 2 + 2 * zone.depth, "",
+                     zone.name, profiler.averageMs(zone.name, AVERAGE_FRAMES));
+            lines += line;
+        }
+        for (int i = 0; i < frame.counterCount; i++) {
+            snprintf(line, sizeof line, "%-14s %ld\n", frame.counters[i].name, frame.counters[i].value);
+            lines += line;
+        }
+
+        text.setString(lines);
+        sf::FloatRect bounds = text.getLocalBounds();
+        float x = W - 30 - bounds.width;
+        text.setPosition(x, 90);
+        background.setPosition(x - 10, 80);
+        background.setSize(sf::Vector2f(bounds.width + 20, bounds.height + 30));
+    }
+};
+
+#endif // HUD_HPP
@@ -0,0 +1,221 @@
+#ifndef JOBS_HPP
+#define JOBS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Small work-stealing thread pool. run() deals a batch of jobs round-robin
+// onto one queue per thread and returns once all of them have finished;
+// the calling thread works through the batch as well. A thread whose own
+// queue is empty steals from the front of the others. Batches are started
+// from one thread only and never from inside a job.
+class JobSystem {
+public:
+    explicit JobSystem(unsigned workerCount = defaultWorkers()) {
+        queues.reserve(workerCount + 1);
+        for (unsigned i = 0; i <= workerCount; i++) {
+            queues.push_back(std::make_unique<Queue>());
+            queues.back()->jobs.reserve(QUEUE_RESERVE);
+        }
+        for (unsigned i = 1; i <= workerCount; i++) {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers) t.join();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // One thread per core, counting the caller
+    static unsigned defaultWorkers() {
+        unsigned cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 0;
+    }
+
+    // Workers plus the calling thread
+    unsigned threadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // Calls f(job) for every job in [0, jobCount), spread over all threads
+    template <typename F>
+    void run(size_t jobCount, F&& f) {
+        if (workers.empty() || jobCount <= 1) {
+            for (size_t i = 0; i < jobCount; i++) f(i);
+            return;
+        }
+
+        using Body = std::remove_reference_t<F>;
+        std::atomic<size_t> remaining{jobCount};
+        Job job;
+        job.call = [](void* body, size_t i) { (*static_cast<Body*>(body))(i); };
+        job.body = const_cast<void*>(static_cast<const void*>(&f));
+        job.remaining = &remaining;
+
+        queued.fetch_add(static_cast<long>(jobCount));
+        for (size_t i = 0; i < jobCount; i++) {
+            Queue& q = *queues[i % queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            job.index = i;
+            q.jobs.push_back(job);
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_all();
+
+        // Help until the whole batch is done, not just our share
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (take(0, job)) {
+                execute(job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    static constexpr size_t QUEUE_RESERVE = 256;
+
+    struct Job {
+        void (*call)(void* body, size_t index);
+        void* body;
+        size_t index;
+        std::atomic<size_t>* remaining;
+    };
+
+    // The owner pops from the back, thieves take from head
+    struct Queue {
+        std::mutex mutex;
+        std::vector<Job> jobs;
+        size_t head = 0;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<long> queued{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    bool take(size_t self, Job& out) {
+        if (popBack(*queues[self], out)) return true;
+        for (size_t k = 1; k < queues.size(); k++) {
+            if (stealFront(*queues[(self + k) % queues.size()], out)) return true;
+        }
+        return false;
+    }
+
+    bool popBack(Queue& q, Job& out) {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.jobs.size() == q.head) return false;
+        out = q.jobs.back();
+        q.jobs.pop_back();
+        reclaim(q);
+        return true;
+    }
+
+    bool stealFront(Queue& q, Job& out) {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.jobs.size() == q.head) return false;
+        out = q.jobs[q.head++];
+        reclaim(q);
+        return true;
+    }
+
+    void reclaim(Queue& q) {
+        queued.fetch_sub(1);
+        if (q.jobs.size() == q.head) {
+            q.jobs.clear();
+            q.head = 0;
+        }
+    }
+
+    static void execute(const Job& job) {
+        job.call(job.body, job.index);
+        job.remaining->fetch_sub(1, std::memory_order_release);
+    }
+
+    void workerLoop(size_t self) {
+        for (;;) {
+            Job job;
+            if (take(self, job)) {
+                execute(job);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [&] { return stopping || queued.load() > 0; });
+            if (stopping) return;
+        }
+    }
+};
+
+// Number of chunks forEachChunk() will split count items into
+inline size_t chunkCount(const JobSystem* jobs, size_t count, size_t grain) {
+    if (count == 0) return 0;
+    if (!jobs) return 1;
+    size_t chunks = std::min((count + grain - 1) / grain, size_t(jobs->threadCount()) * 4);
+    size_t size = (count + chunks - 1) / chunks;
+    return (count + size - 1) / size;
+}
+
+// Splits [0, count) into contiguous chunks of roughly grain items or more
+// and calls f(chunk, begin, end) for each: on the pool when jobs is set,
+// inline otherwise. Chunks are numbered in item order.
+template <typename F>
+void forEachChunk(JobSystem* jobs, size_t count, size_t grain, F&& f) {
+    size_t chunks = chunkCount(jobs, count, grain);
+    if (chunks == 0) return;
+    size_t size = (count + chunks - 1) / chunks;
+    auto body = [&](size_t chunk) {
+        size_t begin = chunk * size;
+        f(chunk, begin, std::min(count, begin + size));
+    };
+    if (jobs) {
+        jobs->run(chunks, body);
+    } else {
+        body(0);
+    }
+}
+
+// Output lists for forEachChunk() bodies, one per chunk. Each chunk only
+// appends to its own list and forEach() replays them in chunk order, so
+// the combined sequence is the same however the work was split or
+// scheduled. Lists keep their capacity across reset().
+template <typename T>
+class ChunkBuffers {
+public:
+    void reset(size_t chunks) {
+        if (lists.size() < chunks) lists.resize(chunks);
+        for (std::vector<T>& list : lists) list.clear();
+        used = chunks;
+    }
+
+    std::vector<T>& operator[](size_t chunk) { return lists[chunk]; }
+
+    template <typename F>
+    void forEach(F&& f) const {
+        for (size_t c = 0; c < used; c++) {
+            for (const T& v : lists[c]) f(v);
+        }
+    }
+
+private:
+    std::vector<std::vector<T>> lists;
+    size_t used = 0;
+};
+
+#endif // JOBS_HPP
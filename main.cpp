@@ -1,30 +1,75 @@
 #include "Asteroids.h"
+#include "world.h"
+#include "sprite_batch.h"
+#include "atlas.h"
+#include "hud.h"
+#include "profiler.h"
+#include "sim_thread.h"
+#include "assets.h"
+#include "audio.h"
+#include "particles.h"
 #include <SFML/Audio.hpp>
 #include <iostream>
 #include <sstream>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+
+// Every heap allocation in the process, reported per frame by the profiler
+std::atomic<long> heapAllocations{0};
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
 
-// Global animations
-Animation sExplosion, sRock, sRock_small, sBullet, sHomingBullet;
-Animation sPlayer, sPlayer_go, sExplosion_ship, sBossRock, sBossExplosion;
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// Shared animation clips, indexed by ClipId
+AnimationClip clips[CLIP_COUNT];
 
 // Initialize global game state
-std::list<std::unique_ptr<Entity>> entities;
-bool bossSpawned = false;
-int asteroidsShotDirectly = 0;
-int asteroidsDestroyedInExplosions = 0;
-int maxAsteroidsDestroyed = 0;
-int activeBossCount = 0;
+World world;
 GameState gameState = GameState::MAIN_MENU;
 
+// Steps the world on its own thread; the loop in main() only draws the
+// snapshots it publishes
+SimulationThread simulation(world);
+
+// All entity sprites, one draw call per run of sprites sharing a texture
+SpriteBatch spriteBatch;
+
+// Explosion effect blasts, one draw call for all of them
+CircleBatch effectCircles;
+
+// Debris and thrust trails, drawn on top of the sprites
+ParticleSystem particles;
+
+// Score, high score, pause button and boss health bars
+Hud hud;
+
+// Frame timings and counters; F3 shows them, F4 writes trace.json
+Profiler profiler;
+ProfilerOverlay profilerOverlay;
+
 // Audio settings
 bool soundEnabled = true;
 float volume = 70.0f;
 sf::Music backgroundMusic, pauseMusic;
-sf::SoundBuffer shootBuffer;
-sf::Sound shootSound;
+AudioMixer mixer;
 
-// Player reference
-Player* playerPtr = nullptr;
+// High scores of every run, read and written on the store's own thread
+ScoreStore scores;
+std::vector<ScoreEntry> topScores;
+Leaderboard leaderboard;
 
 // Menu elements
 Button* startButton = nullptr;
@@ -49,49 +94,10 @@ float volumeSliderMinX = 0;
 float volumeSliderMaxX = 0;
 float brightness = 1.0f;
 
-bool isCollide(const Entity* a, const Entity* b) {
-    return (b->x - a->x) * (b->x - a->x) +
-           (b->y - a->y) * (b->y - a->y) <
-           (a->R + b->R) * (a->R + b->R);
-}
-
-void spawnInitialAsteroids() {
-    for (int i = 0; i < INITIAL_ASTEROIDS; i++) {
-        auto a = std::make_unique<Asteroid>();
-        a->settings(sRock, rand() % W, rand() % H, rand() % 360, 25);
-        entities.push_back(std::move(a));
-    }
-}
-
-void spawnBossAsteroid() {
-    auto boss = std::make_unique<BossAsteroid>();
-    boss->settings(sBossRock, rand() % (W-200) + 100, rand() % (H-200) + 100, rand() % 360, 80);
-    boss->dx = (rand() % 5 - 2) * 0.5f;
-    boss->dy = (rand() % 5 - 2) * 0.5f;
-    entities.push_back(std::move(boss));
-    activeBossCount++;
-    bossSpawned = true;
-}
-
-void drawBossHealth(sf::RenderWindow& app, const BossAsteroid* boss, sf::Font& font) {
-    sf::Text bossHealthText;
-    bossHealthText.setString("BOSS HP: " + std::to_string(boss->health));
-    bossHealthText.setFont(font);
-    bossHealthText.setCharacterSize(24);
-    bossHealthText.setPosition(boss->x - 50, boss->y - 60);
-    bossHealthText.setFillColor(sf::Color::Red);
-    app.draw(bossHealthText);
-
-    sf::RectangleShape healthBarBack(sf::Vector2f(100, 10));
-    healthBarBack.setPosition(boss->x - 50, boss->y - 40);
-    healthBarBack.setFillColor(sf::Color(50, 50, 50));
-    app.draw(healthBarBack);
-
-    float healthPercentage = static_cast<float>(boss->health) / BOSS_MAX_HEALTH;
-    sf::RectangleShape healthBar(sf::Vector2f(100 * healthPercentage, 10));
-    healthBar.setPosition(boss->x - 50, boss->y - 40);
-    healthBar.setFillColor(sf::Color::Red);
-    app.draw(healthBar);
+// Music plays a little quieter than effects
+void applyVolumes() {
+    mixer.setVolume(AudioMixer::Category::Music, soundEnabled ? volume * 0.7f : 0);
+    mixer.setVolume(AudioMixer::Category::Effects, soundEnabled ? volume : 0);
 }
 
 void updateVolumeSlider(float mouseX) {
@@ -110,11 +116,7 @@ void updateVolumeSlider(float mouseX) {
     pauseVolumeText.setString("VOLUME: " + std::to_string(int(volume)) + "%");
 
     // Update audio volumes
-    if (soundEnabled) {
-        shootSound.setVolume(volume);
-        backgroundMusic.setVolume(volume * 0.7f);
-        pauseMusic.setVolume(volume * 0.7f);
-    }
+    applyVolumes();
 }
 
 void initMenu(sf::Font& font) {
@@ -194,6 +196,22 @@ void initMenu(sf::Font& font) {
     pauseVolumeText.setFillColor(sf::Color::White);
 }
 
+// Shown while assets load, so it needs none of them
+void drawLoadingScreen(sf::RenderWindow& app, float progress) {
+    app.clear();
+    sf::RectangleShape track(sf::Vector2f(400, 16));
+    track.setPosition(W/2 - 200, H/2 - 8);
+    track.setFillColor(sf::Color(50, 50, 50));
+    track.setOutlineThickness(2);
+    track.setOutlineColor(sf::Color::White);
+    app.draw(track);
+
+    sf::RectangleShape bar(sf::Vector2f(400 * progress, 16));
+    bar.setPosition(W/2 - 200, H/2 - 8);
+    bar.setFillColor(sf::Color(0, 150, 255));
+    app.draw(bar);
+}
+
 void drawMenu(sf::RenderWindow& app, sf::Font& font) {
     // Draw title
     sf::Text title;
@@ -218,6 +236,8 @@ void drawMenu(sf::RenderWindow& app, sf::Font& font) {
     startButton->draw(app);
     exitButton->draw(app);
 
+    leaderboard.draw(app);
+
     // Draw controls info
     sf::Text controls;
     controls.setString("Controls: W/A/D to move, SPACE to shoot, ENTER for homing missiles");
@@ -240,12 +260,9 @@ void handleMenuEvents(sf::RenderWindow& app, sf::Event& event) {
         if (startButton->isClicked(mousePos, sf::Mouse::Left)) {
             gameState = GameState::PLAYING;
             // Reset game state
-            entities.clear();
-            spawnInitialAsteroids();
-            auto p = std::make_unique<Player>();
-            p->settings(sPlayer, W/2, H/2, 0, 20);
-            playerPtr = p.get();
-            entities.push_back(std::move(p));
+            simulation.requestReset();
+            mixer.stopAll();
+            particles.clear();
 
             // Start game music
             if (soundEnabled) {
@@ -258,20 +275,6 @@ void handleMenuEvents(sf::RenderWindow& app, sf::Event& event) {
     }
 }
 
-void resetGame() {
-    entities.clear();
-    asteroidsShotDirectly = 0;
-    asteroidsDestroyedInExplosions = 0;
-    activeBossCount = 0;
-    bossSpawned = false;
-    spawnInitialAsteroids();
-
-    auto p = std::make_unique<Player>();
-    p->settings(sPlayer, W/2, H/2, 0, 20);
-    playerPtr = p.get();
-    entities.push_back(std::move(p));
-}
-
 void drawPauseMenu(sf::RenderWindow& app) {
     // Dark overlay
     sf::RectangleShape overlay(sf::Vector2f(W, H));
@@ -328,9 +331,7 @@ void handlePauseMenuEvents(sf::RenderWindow& app, sf::Event& event) {
             else if (pauseSoundButton.getGlobalBounds().contains(mousePos)) {
                 soundEnabled = !soundEnabled;
                 pauseSoundText.setString(soundEnabled ? "SOUND: ON" : "SOUND: OFF");
-                backgroundMusic.setVolume(soundEnabled ? volume * 0.7f : 0);
-                pauseMusic.setVolume(soundEnabled ? volume * 0.7f : 0);
-                shootSound.setVolume(soundEnabled ? volume : 0);
+                applyVolumes();
             }
             // Brightness adjustment
             else if (pauseBrightnessButton.getGlobalBounds().contains(mousePos)) {
@@ -363,90 +364,169 @@ void handlePauseMenuEvents(sf::RenderWindow& app, sf::Event& event) {
     }
 }
 
-int main() {
-    srand(static_cast<unsigned>(time(nullptr)));
+int main(int argc, char** argv) {
+    world.rng.seed(static_cast<uint64_t>(time(nullptr)));
+
+    // --record file saves the input of the round for headless --replay
+    const char* recordPath = nullptr;
+    InputLog recording;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0) recordPath = argv[i + 1];
+    }
+    if (recordPath) simulation.recording = &recording;
+
+    // The log is read while the window opens and assets load; the menu and
+    // HUD pick the scores up once they are in
+    scores.start("scores.log");
+    simulation.scores = &scores;
 
     sf::RenderWindow app(sf::VideoMode(W, H), "Asteroids!");
     app.setFramerateLimit(60);
 
-    // Load textures
-    sf::Texture t1, t2, t3, t4, t5, t6, t7, t8;
-    if (!t1.loadFromFile("spaceship.png") || !t2.loadFromFile("background.jpg") ||
-        !t3.loadFromFile("explosions/type_C.png") || !t4.loadFromFile("rock.png") ||
-        !t5.loadFromFile("fire_blue.png") || !t6.loadFromFile("rock_small.png") ||
-        !t7.loadFromFile("explosions/type_B.png") || !t8.loadFromFile("fire_red.png")) {
+    // Worker threads, one per spare core. They decode the assets first and
+    // run the simulation's heavy loops afterwards.
+    JobSystem jobs;
+
+    // Everything is read and decoded in the background while a progress bar
+    // is drawn. The game cannot run without its sprite sheets; without the
+    // rest it just looks or sounds plainer. Sheets are only decoded here and
+    // get packed into the atlas below.
+    using Asset = AssetCache::Type;
+    AssetCache assets;
+    int shipSheet = assets.request(Asset::Image, "spaceship.png");
+    int explosionSheet = assets.request(Asset::Image, "explosions/type_C.png");
+    int rockSheet = assets.request(Asset::Image, "rock.png");
+    int bulletSheet = assets.request(Asset::Image, "fire_blue.png");
+    int smallRockSheet = assets.request(Asset::Image, "rock_small.png");
+    int shipExplosionSheet = assets.request(Asset::Image, "explosions/type_B.png");
+    int homingSheet = assets.request(Asset::Image, "fire_red.png");
+    int backgroundImage = assets.request(Asset::Texture, "background.jpg", false);
+    int fontFile = assets.request(Asset::Font, "Roboto-Bold.ttf", false);
+    int shootFile = assets.request(Asset::Sound, "blaster.ogg", false);
+    assets.start(jobs);
+
+    while (!assets.finished()) {
+        sf::Event event;
+        while (app.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) return EXIT_SUCCESS;
+        }
+        assets.uploadReady();
+        drawLoadingScreen(app, assets.progress());
+        app.display();
+    }
+    assets.uploadReady();
+
+    std::vector<std::string> missing = assets.missingRequired();
+    if (!missing.empty()) {
+        for (const std::string& path : missing) {
+            std::cerr << "Failed to load " << path << "!" << std::endl;
+        }
         return EXIT_FAILURE;
     }
 
-    t1.setSmooth(true);
-    t2.setSmooth(true);
+    sf::Texture* t2 = assets.texture(backgroundImage);
+    if (t2) {
+        t2->setSmooth(true);
+    } else {
+        std::cerr << "Failed to load the background! Using a plain one" << std::endl;
+    }
 
     // Initialize animations
-    sExplosion = Animation(t3, 0, 0, 256, 256, 48, 0.5);
-    sRock = Animation(t4, 0, 0, 64, 64, 16, 0.2);
-    sRock_small = Animation(t6, 0, 0, 64, 64, 16, 0.2);
-    sBullet = Animation(t5, 0, 0, 32, 64, 16, 0.8);
-    sHomingBullet = Animation(t8, 0, 0, 32, 64, 16, 0.8);
-    sPlayer = Animation(t1, 40, 0, 40, 40, 1, 0);
-    sPlayer_go = Animation(t1, 40, 40, 40, 40, 1, 0);
-    sExplosion_ship = Animation(t7, 0, 0, 192, 192, 64, 0.5);
-    sBossRock = sRock;
-    sBossRock.sprite.setScale(2.0f, 2.0f);
-    sBossExplosion = sExplosion_ship;
-    sBossExplosion.sprite.setScale(3.0f, 3.0f);
-
-    // Load font
+    TextureAtlas atlas(std::min(sf::Texture::getMaximumSize(), 4096u));
+    bool packed = true;
+    // Frame counts and speeds live in CLIP_TIMINGS; only the sheet layout is
+    // defined here. Only the ship is drawn smoothed.
+    auto defineClip = [&](ClipId id, int sheet, int x, int y, int w, int h, float scale = 1) {
+        AnimationClip& c = clips[static_cast<int>(id)];
+        c = AnimationClip(id, x, y, w, h, scale);
+        packed = atlas.add(c, *assets.image(sheet), sheet == shipSheet) && packed;
+    };
+    defineClip(ClipId::Explosion, explosionSheet, 0, 0, 256, 256);
+    defineClip(ClipId::Rock, rockSheet, 0, 0, 64, 64);
+    defineClip(ClipId::RockSmall, smallRockSheet, 0, 0, 64, 64);
+    defineClip(ClipId::Bullet, bulletSheet, 0, 0, 32, 64);
+    defineClip(ClipId::HomingBullet, homingSheet, 0, 0, 32, 64);
+    defineClip(ClipId::Player, shipSheet, 40, 0, 40, 40);
+    defineClip(ClipId::PlayerGo, shipSheet, 40, 40, 40, 40);
+    defineClip(ClipId::ExplosionShip, shipExplosionSheet, 0, 0, 192, 192);
+    defineClip(ClipId::BossRock, rockSheet, 0, 0, 64, 64, 2.0f);
+    defineClip(ClipId::BossExplosion, shipExplosionSheet, 0, 0, 192, 192, 3.0f);
+    if (!packed || !atlas.build()) {
+        std::cerr << "Failed to build the texture atlas!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
     sf::Font font;
-    if (!font.loadFromFile("Roboto-Bold.ttf")) {
+    if (const sf::Font* loaded = assets.font(fontFile)) {
+        font = *loaded;
+    } else {
         std::cerr << "Failed to load font! Using default" << std::endl;
-        font = sf::Font();
     }
 
+    world.jobs = &jobs;
+    world.sounds = &mixer.cues;
+    world.debris = &particles.bursts;
+    simulation.start();
+
     // Initialize menus
     initMenu(font);
+    hud.init(font);
+    profilerOverlay.init(font);
+    leaderboard.init(font);
 
     // Audio initialization
     if (!backgroundMusic.openFromFile("Game.ogg")) {
         std::cerr << "Failed to load background music!" << std::endl;
     } else {
         backgroundMusic.setLoop(true);
-        backgroundMusic.setVolume(volume * 0.7f);
     }
 
     if (!pauseMusic.openFromFile("pause.ogg")) {
         std::cerr << "Failed to load pause music!" << std::endl;
     } else {
         pauseMusic.setLoop(true);
-        pauseMusic.setVolume(volume * 0.7f);
     }
 
-    if (!shootBuffer.loadFromFile("blaster.ogg")) {
+    mixer.addMusic(backgroundMusic);
+    mixer.addMusic(pauseMusic);
+
+    // Homing missiles reuse the blaster, but are harder to cut off
+    const sf::SoundBuffer* shot = assets.sound(shootFile);
+    if (!shot) {
         std::cerr << "Failed to load shooting sound!" << std::endl;
-    } else {
-        shootSound.setBuffer(shootBuffer);
-        shootSound.setVolume(volume);
     }
-
-    // Game timing
-    float shootCooldown = 0.0f;
-    const float shootCooldownTime = 0.15f;
-    float homingShootCooldown = 0.0f;
-    const float homingShootCooldownTime = 1.5f;
-
-    sf::Clock clock;
+    mixer.setCue(SoundId::Shot, shot, 1);
+    mixer.setCue(SoundId::HomingShot, shot, 2);
+    applyVolumes();
 
     // Main game loop
+    Snapshot::Clock::time_point lastFrame = Snapshot::Clock::now();
+    int loadsSeen = 0;
     while (app.isOpen()) {
-        float dt = clock.restart().asSeconds();
-        int currentScore = 0;
+        Input input;
+        long allocationsAtStart = heapAllocations.load(std::memory_order_relaxed);
+        profiler.beginFrame();
 
         // Event handling
+        int eventsZone = profiler.begin("events");
         sf::Event event;
         while (app.pollEvent(event)) {
             if (event.type == sf::Event::Closed) {
                 app.close();
             }
 
+            // Profiler controls work in every state
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+                profilerOverlay.toggle();
+            }
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F4) {
+                if (profiler.exportTrace("trace.json")) {
+                    std::cout << "Wrote " << profiler.frameCount() << " frames to trace.json" << std::endl;
+                } else {
+                    std::cerr << "Failed to write trace.json!" << std::endl;
+                }
+            }
+
             switch (gameState) {
                 case GameState::MAIN_MENU:
                     handleMenuEvents(app, event);
@@ -476,16 +556,16 @@ int main() {
                         }
                     }
 
-                    if (gameState == GameState::PLAYING) {
-                        if (event.type == sf::Event::KeyPressed) {
-                            if (event.key.code == sf::Keyboard::Enter && homingShootCooldown <= 0) {
-                                auto b = std::make_unique<HomingBullet>();
-                                b->settings(sHomingBullet, playerPtr->x, playerPtr->y, playerPtr->angle, 10);
-                                entities.push_back(std::move(b));
-                                homingShootCooldown = homingShootCooldownTime;
-                                if (soundEnabled) shootSound.play();
-                            }
-                        }
+                    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Enter) {
+                        input.fireHoming = true;
+                    }
+
+                    // Quick-save and quick-load
+                    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F5) {
+                        simulation.requestSave("quicksave.bin");
+                    }
+                    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F9) {
+                        simulation.requestLoad("quicksave.bin");
                     }
                     break;
 
@@ -495,269 +575,57 @@ int main() {
             }
         }
 
-        // Update based on game state
-        switch (gameState) {
-            case GameState::MAIN_MENU:
-                // Menu doesn't need updates beyond what's handled in events
-                break;
-
-            case GameState::PLAYING: {
-                // Update cooldowns
-                shootCooldown -= dt;
-                homingShootCooldown -= dt;
-
-                // Player controls
-                if (playerPtr) {
-                    if (sf::Keyboard::isKeyPressed(sf::Keyboard::D)) playerPtr->angle += 3;
-                    if (sf::Keyboard::isKeyPressed(sf::Keyboard::A)) playerPtr->angle -= 3;
-                    playerPtr->thrust = sf::Keyboard::isKeyPressed(sf::Keyboard::W);
-
-                    // Continuous firing when space is held down
-                    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space) && shootCooldown <= 0) {
-                        auto b = std::make_unique<Bullet>();
-                        b->settings(sBullet, playerPtr->x, playerPtr->y, playerPtr->angle, 10);
-                        entities.push_back(std::move(b));
-                        shootCooldown = shootCooldownTime;
-                        if (soundEnabled) shootSound.play();
-                    }
-                }
-
-                // Collision detection
-                for (auto itA = entities.begin(); itA != entities.end(); ++itA) {
-                    for (auto itB = std::next(itA); itB != entities.end(); ++itB) {
-                        Entity* a = itA->get();
-                        Entity* b = itB->get();
-
-                        if ((a->name == "player" && (b->name == "asteroid" || b->name == "boss")) ||
-                            (b->name == "player" && (a->name == "asteroid" || a->name == "boss"))) {
-
-                            Entity* player = (a->name == "player") ? a : b;
-                            Entity* asteroid = (a->name == "asteroid" || a->name == "boss") ? a : b;
-
-                            if (isCollide(player, asteroid)) {
-                                asteroid->life = false;
-                                if (asteroid->name == "boss") {
-                                    static_cast<BossAsteroid*>(asteroid)->spawnChildren = false;
-                                    activeBossCount--;
-                                }
-
-                                int totalDestroyed = asteroidsShotDirectly + asteroidsDestroyedInExplosions;
-                                maxAsteroidsDestroyed = std::max(maxAsteroidsDestroyed, totalDestroyed);
-
-                                // Reset only current score, keep max
-                                asteroidsShotDirectly = 0;
-                                asteroidsDestroyedInExplosions = 0;
-
-                                // Clear all asteroids and bullets
-                                entities.remove_if([](const std::unique_ptr<Entity>& e) {
-                                    return e->name == "asteroid" || e->name == "bullet" ||
-                                           e->name == "homingbullet" || e->name == "boss";
-                                });
-                                activeBossCount = 0;
-
-                                // Respawn initial asteroids
-                                spawnInitialAsteroids();
-
-                                // Create explosion effect
-                                auto explosion = std::make_unique<Explosion>();
-                                if (asteroid->name == "boss") {
-                                    explosion->settings(sBossExplosion, player->x, player->y);
-                                } else {
-                                    explosion->settings(sExplosion_ship, player->x, player->y);
-                                }
-                                entities.push_back(std::move(explosion));
-
-                                // Reset player
-                                player->settings(sPlayer, W/2, H/2, 0, 20);
-                                player->dx = 0;
-                                player->dy = 0;
-                            }
-                        }
-                        // Bullet vs Boss collision
-                        else if ((a->name == "boss" && b->name == "bullet") ||
-                                (b->name == "boss" && a->name == "bullet")) {
-
-                            Entity* boss = (a->name == "boss") ? a : b;
-                            Entity* bullet = (a->name == "bullet") ? a : b;
-
-                            if (isCollide(boss, bullet)) {
-                                bullet->life = false;
-                                BossAsteroid* bossObj = static_cast<BossAsteroid*>(boss);
-                                bossObj->health -= static_cast<Bullet*>(bullet)->damage;
-
-                                auto hitEffect = std::make_unique<Explosion>();
-                                hitEffect->settings(sExplosion_ship, bullet->x, bullet->y);
-                                entities.push_back(std::move(hitEffect));
-
-                                if (bossObj->health <= 0) {
-                                    boss->life = false;
-                                    activeBossCount--;
-                                    auto explosion = std::make_unique<Explosion>();
-                                    explosion->settings(sBossExplosion, boss->x, boss->y);
-                                    entities.push_back(std::move(explosion));
-
-                                    // Spawn 8 regular asteroids when boss is destroyed
-                                    if (bossObj->spawnChildren) {
-                                        for (int i = 0; i < 8; i++) {
-                                            auto a = std::make_unique<Asteroid>();
-                                            a->settings(sRock_small, boss->x, boss->y, rand() % 360, 15);
-                                            // Inherit some boss velocity
-                                            a->dx = boss->dx * 0.5f + (rand() % 4 - 2);
-                                            a->dy = boss->dy * 0.5f + (rand() % 4 - 2);
-                                            entities.push_back(std::move(a));
-                                        }
-                                    }
-
-                                    bossSpawned = activeBossCount > 0;
-                                    asteroidsShotDirectly += 10;
-                                }
-                            }
-                        }
-                        // HomingBullet vs Boss collision
-                        else if ((a->name == "boss" && b->name == "homingbullet") ||
-                                (b->name == "boss" && a->name == "homingbullet")) {
-
-                            Entity* boss = (a->name == "boss") ? a : b;
-                            Entity* bullet = (a->name == "homingbullet") ? a : b;
-
-                            if (isCollide(boss, bullet)) {
-                                bullet->life = false;
-                                BossAsteroid* bossObj = static_cast<BossAsteroid*>(boss);
-                                bossObj->health -= static_cast<HomingBullet*>(bullet)->damage;
-
-                                auto hitEffect = std::make_unique<Explosion>();
-                                hitEffect->settings(sExplosion, bullet->x, bullet->y);
-                                entities.push_back(std::move(hitEffect));
-
-                                if (bossObj->health <= 0) {
-                                    boss->life = false;
-                                    activeBossCount--;
-                                    auto explosion = std::make_unique<Explosion>();
-                                    explosion->settings(sBossExplosion, boss->x, boss->y);
-                                    entities.push_back(std::move(explosion));
-
-                                    // Spawn 8 regular asteroids when boss is destroyed
-                                    if (bossObj->spawnChildren) {
-                                        for (int i = 0; i < 8; i++) {
-                                            auto a = std::make_unique<Asteroid>();
-                                            a->settings(sRock_small, boss->x, boss->y, rand() % 360, 15);
-                                            // Inherit some boss velocity
-                                            a->dx = boss->dx * 0.5f + (rand() % 4 - 2);
-                                            a->dy = boss->dy * 0.5f + (rand() % 4 - 2);
-                                            entities.push_back(std::move(a));
-                                        }
-                                    }
-
-                                    bossSpawned = activeBossCount > 0;
-                                    asteroidsShotDirectly += 10;
-                                }
-                            }
-                        }
-                        // Bullet vs Asteroid collision
-                        else if ((a->name == "asteroid" && b->name == "bullet") ||
-                                (b->name == "asteroid" && a->name == "bullet")) {
-
-                            Entity* asteroid = (a->name == "asteroid") ? a : b;
-                            Entity* bullet = (a->name == "bullet") ? a : b;
-
-                            if (isCollide(asteroid, bullet)) {
-                                asteroid->life = false;
-                                bullet->life = false;
-                                asteroidsShotDirectly++;
-
-                                auto explosion = std::make_unique<Explosion>();
-                                explosion->settings(sExplosion, asteroid->x, asteroid->y);
-                                entities.push_back(std::move(explosion));
-
-                                if (asteroid->R != 15) {
-                                    for (int i = 0; i < 2; i++) {
-                                        auto smallAsteroid = std::make_unique<Asteroid>();
-                                        smallAsteroid->settings(sRock_small, asteroid->x, asteroid->y, rand() % 360, 15);
-                                        entities.push_back(std::move(smallAsteroid));
-                                    }
-                                }
-                            }
-                        }
-                        // HomingBullet vs Asteroid collision
-                        else if ((a->name == "asteroid" && b->name == "homingbullet") ||
-                                (b->name == "asteroid" && a->name == "homingbullet")) {
-
-                            Entity* asteroid = (a->name == "asteroid") ? a : b;
-                            Entity* bullet = (a->name == "homingbullet") ? a : b;
-
-                            if (isCollide(asteroid, bullet)) {
-                                asteroid->life = false;
-                                bullet->life = false;
-                                asteroidsShotDirectly++;
-
-                                auto explosion = std::make_unique<Explosion>();
-                                explosion->settings(sExplosion, asteroid->x, asteroid->y);
-                                entities.push_back(std::move(explosion));
-
-                                auto explosionEffect = std::make_unique<ExplosionEffect>();
-                                explosionEffect->x = asteroid->x;
-                                explosionEffect->y = asteroid->y;
-                                entities.push_back(std::move(explosionEffect));
-
-                                if (asteroid->R != 15) {
-                                    for (int i = 0; i < 2; i++) {
-                                        auto smallAsteroid = std::make_unique<Asteroid>();
-                                        smallAsteroid->settings(sRock_small, asteroid->x, asteroid->y, rand() % 360, 15);
-                                        entities.push_back(std::move(smallAsteroid));
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-
-                // Update animations and clean up
-                if (playerPtr) {
-                    playerPtr->anim = playerPtr->thrust ? sPlayer_go : sPlayer;
-                }
-                entities.remove_if([](const std::unique_ptr<Entity>& e) {
-                    if (e->name == "explosionEffect" && !e->life) {
-                        asteroidsDestroyedInExplosions += static_cast<ExplosionEffect*>(e.get())->damageDealt;
-                    }
-                    return (e->name == "explosion" && e->anim.isEnd()) ||
-                           (e->name == "explosionEffect" && !e->life) ||
-                           !e->life;
-                });
-
-                // Spawn logic
-                currentScore = asteroidsShotDirectly + asteroidsDestroyedInExplosions;
-                if (currentScore >= BOSS_TRIGGER_SCORE &&
-                    activeBossCount < MAX_BOSS_ASTEROIDS &&
-                    rand() % 100 == 0) {
-                    spawnBossAsteroid();
-                }
-                else if (!bossSpawned && rand() % 150 == 0) {
-                    auto a = std::make_unique<Asteroid>();
-                    a->settings(sRock, 0, rand() % H, rand() % 360, 25);
-                    entities.push_back(std::move(a));
-                }
+        profiler.end(eventsZone);
 
-                // Update all entities
-                for (auto& e : entities) {
-                    e->update();
-                    if (e->name != "explosionEffect") {
-                        e->anim.update();
-                    }
-                }
-                break;
+        // Hand the input to the simulation thread, which ticks on its own
+        // clock while the game is playing
+        if (gameState == GameState::PLAYING) {
+            input.turnRight = sf::Keyboard::isKeyPressed(sf::Keyboard::D);
+            input.turnLeft = sf::Keyboard::isKeyPressed(sf::Keyboard::A);
+            input.thrust = sf::Keyboard::isKeyPressed(sf::Keyboard::W);
+            input.fire = sf::Keyboard::isKeyPressed(sf::Keyboard::Space);
+        }
+        simulation.setInput(input);
+        simulation.setRunning(gameState == GameState::PLAYING);
+
+        simulation.snapshots.acquire();
+        const Snapshot& snapshot = simulation.snapshots.front();
+        // Once a quick-load has gone through, nothing of the old world may
+        // play on over the loaded one
+        if (snapshot.loads != loadsSeen) {
+            loadsSeen = snapshot.loads;
+            mixer.stopAll();
+            particles.clear();
+        }
+        mixer.update();
+        if (scores.fetch(topScores)) leaderboard.set(topScores);
+        // Entities are drawn between the last two ticks
+        Snapshot::Clock::time_point now = Snapshot::Clock::now();
+        float alpha = snapshot.alpha(now);
+        float back = 1 - alpha;
+        float frameSeconds = std::min(std::chrono::duration<float>(now - lastFrame).count(), 0.1f);
+        lastFrame = now;
+
+        // Particles run on the frame clock and freeze with the game
+        if (gameState == GameState::PLAYING) {
+            particles.drainBursts();
+            for (const SpriteState& s : snapshot.sprites) {
+                if (s.clip != ClipId::PlayerGo) continue;
+                particles.emitThrust(s.x - s.stepX * back, s.y - s.stepY * back, s.angle - s.stepAngle * back,
+                                     s.stepX / TICK_DT, s.stepY / TICK_DT, frameSeconds);
             }
-
-            case GameState::PAUSED:
-                // Pause state doesn't need updates
-                break;
+            particles.update(frameSeconds);
         }
 
         // Draw everything
+        int drawZone = profiler.begin("draw");
         app.clear();
 
         // Draw background (for all states)
-        sf::Sprite background(t2);
-        app.draw(background);
+        if (t2) {
+            sf::Sprite background(*t2);
+            app.draw(background);
+        }
 
         // Apply brightness
         if (brightness < 1.0f) {
@@ -768,31 +636,35 @@ int main() {
 
         // Draw game entities (when not in main menu)
         if (gameState != GameState::MAIN_MENU) {
-            for (auto& e : entities) {
-                e->draw(app);
-                if (e->name == "boss") {
-                    drawBossHealth(app, static_cast<BossAsteroid*>(e.get()), font);
-                }
+            int spritesZone = profiler.begin("sprites");
+            spriteBatch.begin();
+            for (const SpriteState& s : snapshot.sprites) {
+                const AnimationClip& clip = clipOf(s.clip);
+                if (clip.frames.empty()) continue;
+                spriteBatch.add(clip.texture, clip.frames[s.frame],
+                                s.x - s.stepX * back, s.y - s.stepY * back,
+                                s.angle - s.stepAngle * back + 90, clip.scale);
+            }
+            spriteBatch.draw(app);
+            particles.draw(app);
+            profiler.end(spritesZone);
+
+            hud.bossBars.begin();
+            for (const BossBarState& bar : snapshot.bossBars) {
+                hud.bossBars.add(bar.x - bar.stepX * back, bar.y - bar.stepY * back, bar.health);
             }
+            hud.bossBars.draw(app);
 
-            // Draw score
-            currentScore = asteroidsShotDirectly + asteroidsDestroyedInExplosions;
-            sf::Text scoreText;
-            scoreText.setString("Score: " + std::to_string(currentScore));
-            scoreText.setFont(font);
-            scoreText.setCharacterSize(24);
-            scoreText.setPosition(20, 20);
-            scoreText.setFillColor(sf::Color::White);
-            app.draw(scoreText);
-
-            // Draw high score
-            sf::Text highScoreText;
-            highScoreText.setString("High Score: " + std::to_string(maxAsteroidsDestroyed));
-            highScoreText.setFont(font);
-            highScoreText.setCharacterSize(24);
-            highScoreText.setPosition(20, 50);
-            highScoreText.setFillColor(sf::Color::White);
-            app.draw(highScoreText);
+            effectCircles.begin();
+            for (const EffectState& effect : snapshot.effects) {
+                effectCircles.add(effect.x, effect.y, effect.size, sf::Color(255, 50, 50, 100), sf::Color::Red, 2);
+            }
+            effectCircles.draw(app);
+
+            // Draw score and high score
+            hud.score.set(snapshot.score);
+            hud.highScore.set(std::max(snapshot.highScore, topScores.empty() ? 0 : topScores[0].score));
+            hud.drawScores(app);
         }
 
         // State-specific UI
@@ -801,31 +673,58 @@ int main() {
                 drawMenu(app, font);
                 break;
 
-            case GameState::PLAYING: {
-                // Draw pause button
-                sf::RectangleShape pauseBtn(sf::Vector2f(120, 50));
-                pauseBtn.setPosition(W - 140, 20);
-                pauseBtn.setFillColor(sf::Color(70, 70, 70, 220));
-                pauseBtn.setOutlineThickness(2);
-                pauseBtn.setOutlineColor(sf::Color::White);
-                app.draw(pauseBtn);
-
-                sf::Text pauseTxt;
-                pauseTxt.setString("PAUSE");
-                pauseTxt.setFont(font);
-                pauseTxt.setCharacterSize(24);
-                pauseTxt.setPosition(W - 120, 30);
-                pauseTxt.setFillColor(sf::Color::White);
-                app.draw(pauseTxt);
+            case GameState::PLAYING:
+                hud.drawPauseButton(app);
                 break;
-            }
 
             case GameState::PAUSED:
                 drawPauseMenu(app);
                 break;
         }
 
+        profilerOverlay.draw(app, profiler);
+        profiler.end(drawZone);
+
+        int displayZone = profiler.begin("display");
         app.display();
+        profiler.end(displayZone);
+
+        // Simulation phases are timed on their own thread; the latest tick
+        // is reported alongside the frame
+        static const char* const phaseCounters[PHASE_COUNT] = {
+            "sim input us", "sim collide us", "sim spawn us", "sim commit us", "sim update us"};
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            profiler.count(phaseCounters[phase], snapshot.phaseMicros[phase]);
+        }
+        profiler.count("asteroids", snapshot.kindCounts[static_cast<int>(EntityKind::Asteroid)]);
+        profiler.count("bosses", snapshot.kindCounts[static_cast<int>(EntityKind::Boss)]);
+        profiler.count("bullets", snapshot.kindCounts[static_cast<int>(EntityKind::Bullet)]);
+        profiler.count("homing", snapshot.kindCounts[static_cast<int>(EntityKind::HomingBullet)]);
+        profiler.count("explosions", snapshot.kindCounts[static_cast<int>(EntityKind::Explosion)]);
+        profiler.count("effects", snapshot.kindCounts[static_cast<int>(EntityKind::ExplosionEffect)]);
+        profiler.count("sprite draws", spriteBatch.drawCalls());
+        profiler.count("particles", particles.drawnCount());
+        profiler.count("allocations", heapAllocations.load(std::memory_order_relaxed) - allocationsAtStart);
+        profiler.count("pool growths", snapshot.poolGrowths);
+        profiler.endFrame();
+    }
+
+    simulation.stop();
+
+    // A round still in progress counts too
+    if (gameState != GameState::MAIN_MENU) scores.record(world.score());
+    scores.stop();
+
+    if (recordPath) {
+        if (recording.save(recordPath)) {
+            std::cout << "Recorded " << recording.tickCount() << " ticks to " << recordPath << std::endl;
+        } else {
+            std::cerr << "Failed to write " << recordPath << "!" << std::endl;
+        }
+    }
+    if (world.poolGrowths() > 0) {
+        std::cerr << "Entity pools grew " << world.poolGrowths()
+                  << " times, consider raising the *_CAPACITY constants" << std::endl;
     }
 
     // Clean up
@@ -0,0 +1,64 @@
+#ifndef NARROWPHASE_HPP
+#define NARROWPHASE_HPP
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Circle overlap tests of one circle against packed candidates, using the
+// same arithmetic as isCollide() so a SIMD hit is exactly a scalar hit.
+// All eight (or sixteen) candidate slots are read; callers mask off the
+// lanes past their real candidate count.
+
+// Bit k is set when circle (x, y, r) overlaps circle (xs[k], ys[k], rs[k])
+inline unsigned overlapMask8(float x, float y, float r, const float* xs, const float* ys, const float* rs) {
+#if defined(__AVX__)
+    __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs), _mm256_set1_ps(x));
+    __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys), _mm256_set1_ps(y));
+    __m256 reach = _mm256_add_ps(_mm256_set1_ps(r), _mm256_loadu_ps(rs));
+    __m256 dist = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+    return _mm256_movemask_ps(_mm256_cmp_ps(dist, _mm256_mul_ps(reach, reach), _CMP_LT_OQ));
+#elif defined(__SSE2__)
+    unsigned mask = 0;
+    for (int half = 0; half < 2; half++) {
+        int o = half * 4;
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + o), _mm_set1_ps(x));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + o), _mm_set1_ps(y));
+        __m128 reach = _mm_add_ps(_mm_set1_ps(r), _mm_loadu_ps(rs + o));
+        __m128 dist = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        mask |= _mm_movemask_ps(_mm_cmplt_ps(dist, _mm_mul_ps(reach, reach))) << o;
+    }
+    return mask;
+#else
+    unsigned mask = 0;
+    for (int k = 0; k < 8; k++) {
+        float dx = xs[k] - x;
+        float dy = ys[k] - y;
+        float reach = r + rs[k];
+        if (dx * dx + dy * dy < reach * reach) mask |= 1u << k;
+    }
+    return mask;
+#endif
+}
+
+inline unsigned overlapMask16(float x, float y, float r, const float* xs, const float* ys, const float* rs) {
+    return overlapMask8(x, y, r, xs, ys, rs) | overlapMask8(x, y, r, xs + 8, ys + 8, rs + 8) << 8;
+}
+
+// Index of the lowest set bit; bits must not be zero
+inline int lowestBit(unsigned bits) {
+#if defined(__GNUC__)
+    return __builtin_ctz(bits);
+#else
+    int i = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+#endif // NARROWPHASE_HPP
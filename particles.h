@@ -0,0 +1,168 @@
+#ifndef PARTICLES_HPP
+#define PARTICLES_HPP
+
+#include "world.h"
+#include "rng.h"
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Debris and thrust trails. Particles are cosmetic, so they live on the
+// render side, run on the frame clock and draw from their own random
+// numbers; the simulation only reports what broke apart, through bursts.
+//
+// Storage is a ring of CAPACITY slots in columns, allocated once: emitting
+// takes the slot after the newest particle, overwriting the oldest one when
+// the ring is full, and the ring's tail moves up past particles as they
+// expire. All live particles are updated in one pass over the columns and
+// drawn as additive quads from one vertex array in a single draw call.
+class ParticleSystem {
+public:
+    static constexpr size_t CAPACITY = 1 << 16;
+
+    // Filled by the simulation thread, emptied by drainBursts()
+    DebrisQueue bursts;
+
+    ParticleSystem() {
+        for (std::vector<float>* column : {&x, &y, &dx, &dy, &age, &lifetime, &size}) column->resize(CAPACITY);
+        color.resize(CAPACITY);
+        vertices.resize(CAPACITY * 4);
+    }
+
+    // Throws debris for every burst queued since the last call
+    void drainBursts() {
+        DebrisBurst b;
+        while (bursts.pop(b)) emitDebris(b);
+    }
+
+    // A piece broken off every ~1/DEBRIS_PER_RADIUS of radius, flying out
+    // faster from bigger rocks and carrying half the rock's velocity
+    void emitDebris(const DebrisBurst& b) {
+        int count = static_cast<int>(b.radius * DEBRIS_PER_RADIUS);
+        float speed = DEBRIS_SPEED * b.radius / 25;
+        for (int i = 0; i < count; i++) {
+            float direction = uniform(0, 2 * 3.14159265f);
+            float v = speed * uniform(0.2f, 1);
+            bool spark = rng.below(3) == 0;
+            emit(b.x + std::cos(direction) * b.radius * 0.5f, b.y + std::sin(direction) * b.radius * 0.5f,
+                 b.dx * 0.5f + std::cos(direction) * v, b.dy * 0.5f + std::sin(direction) * v,
+                 uniform(0.5f, 1.2f), spark ? 2 : uniform(2, 4),
+                 spark ? sf::Color(255, 170, 60) : sf::Color(150, 130, 110));
+        }
+    }
+
+    // Exhaust of a ship at (shipX, shipY) facing angle degrees and moving at
+    // (shipDX, shipDY) per second, for dt seconds of thrust
+    void emitThrust(float shipX, float shipY, float angle, float shipDX, float shipDY, float dt) {
+        thrustCarry += THRUST_RATE * dt;
+        float c = std::cos(angle * DEGTORAD);
+        float s = std::sin(angle * DEGTORAD);
+        for (; thrustCarry >= 1; thrustCarry--) {
+            float back = uniform(120, 220);
+            float side = uniform(-30, 30);
+            emit(shipX - c * 16, shipY - s * 16,
+                 shipDX - c * back - s * side, shipDY - s * back + c * side,
+                 uniform(0.25f, 0.5f), 3,
+                 sf::Color(255, static_cast<uint8_t>(uniform(160, 220)), 60));
+        }
+    }
+
+    void update(float dt) {
+        const float drag = std::pow(DRAG, dt);
+        forEachSpan([&](size_t begin, size_t end) {
+            float* px = x.data();
+            float* py = y.data();
+            float* vx = dx.data();
+            float* vy = dy.data();
+            float* a = age.data();
+            for (size_t i = begin; i < end; i++) {
+                px[i] += vx[i] * dt;
+                py[i] += vy[i] * dt;
+                vx[i] *= drag;
+                vy[i] *= drag;
+                a[i] += dt;
+            }
+        });
+        while (live > 0 && age[tail()] >= lifetime[tail()]) live--;
+    }
+
+    // Quads shrink and fade out over each particle's lifetime
+    void draw(sf::RenderTarget& target) {
+        size_t n = 0;
+        forEachSpan([&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                float left = 1 - age[i] / lifetime[i];
+                if (left <= 0) continue;
+                float h = size[i] * (0.5f + 0.5f * left);
+                sf::Color c = color[i];
+                c.a = static_cast<uint8_t>(255 * left);
+                sf::Vertex* quad = &vertices[n * 4];
+                quad[0] = sf::Vertex(sf::Vector2f(x[i] - h, y[i] - h), c);
+                quad[1] = sf::Vertex(sf::Vector2f(x[i] + h, y[i] - h), c);
+                quad[2] = sf::Vertex(sf::Vector2f(x[i] + h, y[i] + h), c);
+                quad[3] = sf::Vertex(sf::Vector2f(x[i] - h, y[i] + h), c);
+                n++;
+            }
+        });
+        drawn = n;
+        if (n > 0) target.draw(vertices.data(), n * 4, sf::Quads, sf::RenderStates(sf::BlendAdd));
+    }
+
+    // Drops every particle and every burst still queued
+    void clear() {
+        DebrisBurst b;
+        while (bursts.pop(b)) {}
+        live = 0;
+        thrustCarry = 0;
+    }
+
+    // Particles drawn by the last draw()
+    size_t drawnCount() const { return drawn; }
+
+private:
+    static constexpr float DEBRIS_PER_RADIUS = 1.5f;
+    static constexpr float DEBRIS_SPEED = 160; // per second, for a full-size rock
+    static constexpr float THRUST_RATE = 240;  // particles per second
+    static constexpr float DRAG = 0.3f;        // velocity kept after a second
+
+    std::vector<float> x, y, dx, dy, age, lifetime, size;
+    std::vector<sf::Color> color;
+    std::vector<sf::Vertex> vertices;
+    size_t head = 0; // slot the next particle goes into
+    size_t live = 0; // slots in use, counting back from head
+    size_t drawn = 0;
+    float thrustCarry = 0;
+    Rng rng{0x9A27};
+
+    size_t tail() const { return (head - live) & (CAPACITY - 1); }
+
+    float uniform(float lo, float hi) { return lo + (hi - lo) * (rng.next() * (1.0f / 4294967296.0f)); }
+
+    void emit(float px, float py, float vx, float vy, float life, float half, sf::Color c) {
+        x[head] = px;
+        y[head] = py;
+        dx[head] = vx;
+        dy[head] = vy;
+        age[head] = 0;
+        lifetime[head] = life;
+        size[head] = half;
+        color[head] = c;
+        head = (head + 1) & (CAPACITY - 1);
+        if (live < CAPACITY) live++;
+    }
+
+    // The live slots as at most two contiguous ranges, oldest first
+    template <typename F>
+    void forEachSpan(F&& f) {
+        size_t begin = tail();
+        if (begin + live <= CAPACITY) {
+            f(begin, begin + live);
+        } else {
+            f(begin, CAPACITY);
+            f(0, head);
+        }
+    }
+};
+
+#endif // PARTICLES_HPP
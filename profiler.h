@@ -0,0 +1,158 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// Per-frame profiler: nested scoped timers plus named counters. The last
+// HISTORY frames are kept in fixed storage, so recording never allocates
+// and does not skew the allocation counts it is often used to report.
+// exportTrace() writes them in the Chrome trace event format, which
+// chrome://tracing and ui.perfetto.dev both open.
+class Profiler {
+public:
+    static constexpr int MAX_ZONES = 48;
+    static constexpr int MAX_COUNTERS = 16;
+    static constexpr int HISTORY = 600;
+
+    struct Zone {
+        const char* name;
+        int64_t start, end; // microseconds since the profiler was created
+        int depth;
+    };
+
+    struct Counter {
+        const char* name;
+        long value;
+    };
+
+    struct Frame {
+        int64_t start = 0, end = 0;
+        Zone zones[MAX_ZONES];
+        int zoneCount = 0;
+        Counter counters[MAX_COUNTERS];
+        int counterCount = 0;
+    };
+
+    Profiler() : origin(Clock::now()) {}
+
+    void beginFrame() {
+        current = (current + 1) % HISTORY;
+        Frame& f = frames[current];
+        f.start = now();
+        f.end = f.start;
+        f.zoneCount = 0;
+        f.counterCount = 0;
+        depth = 0;
+    }
+
+    void endFrame() {
+        frames[current].end = now();
+        last = current;
+        // One slot is always left for the frame being recorded
+        if (recorded < HISTORY - 1) recorded++;
+    }
+
+    // Returns a token for end(), or -1 if the frame is out of zone slots
+    int begin(const char* name) {
+        Frame& f = frames[current];
+        if (f.zoneCount == MAX_ZONES) return -1;
+        f.zones[f.zoneCount] = {name, now(), 0, depth++};
+        return f.zoneCount++;
+    }
+
+    void end(int zone) {
+        if (zone < 0) return;
+        frames[current].zones[zone].end = now();
+        depth--;
+    }
+
+    void count(const char* name, long value) {
+        Frame& f = frames[current];
+        if (f.counterCount < MAX_COUNTERS) f.counters[f.counterCount++] = {name, value};
+    }
+
+    // Number of completed frames available; frame(0) is the newest
+    int frameCount() const { return recorded; }
+
+    const Frame& frame(int age) const {
+        return frames[(last - age + HISTORY) % HISTORY];
+    }
+
+    // Mean time in milliseconds spent in zones called name over the last
+    // `over` completed frames (summed within each frame)
+    double averageMs(const char* name, int over) const {
+        int n = over < recorded ? over : recorded;
+        if (n == 0) return 0;
+        int64_t total = 0;
+        for (int age = 0; age < n; age++) {
+            const Frame& f = frame(age);
+            for (int i = 0; i < f.zoneCount; i++) {
+                if (strcmp(f.zones[i].name, name) == 0) total += f.zones[i].end - f.zones[i].start;
+            }
+        }
+        return total / 1000.0 / n;
+    }
+
+    double averageFrameMs(int over) const {
+        int n = over < recorded ? over : recorded;
+        if (n == 0) return 0;
+        int64_t total = 0;
+        for (int age = 0; age < n; age++) total += frame(age).end - frame(age).start;
+        return total / 1000.0 / n;
+    }
+
+    // Writes every recorded frame, oldest first
+    bool exportTrace(const char* path) const {
+        FILE* out = fopen(path, "w");
+        if (!out) return false;
+
+        fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+        bool first = true;
+        auto separator = [&] {
+            if (!first) fprintf(out, ",\n");
+            first = false;
+        };
+        for (int age = recorded - 1; age >= 0; age--) {
+            const Frame& f = frame(age);
+            separator();
+            fprintf(out, "{\"name\": \"frame\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                         "\"ts\": %lld, \"dur\": %lld}",
+                    (long long)f.start, (long long)(f.end - f.start));
+            for (int i = 0; i < f.zoneCount; i++) {
+                const Zone& z = f.zones[i];
+                separator();
+                fprintf(out, "{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                             "\"ts\": %lld, \"dur\": %lld}",
+                        z.name, (long long)z.start, (long long)(z.end - z.start));
+            }
+            for (int i = 0; i < f.counterCount; i++) {
+                const Counter& c = f.counters[i];
+                separator();
+                fprintf(out, "{\"name\": \"%s\", \"ph\": \"C\", \"pid\": 1, \"ts\": %lld, "
+                             "\"args\": {\"value\": %ld}}",
+                        c.name, (long long)f.start, c.value);
+            }
+        }
+        fprintf(out, "\n]}\n");
+        return fclose(out) == 0;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point origin;
+    Frame frames[HISTORY];
+    int current = HISTORY - 1;
+    int last = HISTORY - 1;
+    int recorded = 0;
+    int depth = 0;
+
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - origin).count();
+    }
+};
+
+#endif // PROFILER_HPP
@@ -0,0 +1,165 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include "world.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// The input of every tick of one game, plus the seed the world was reset
+// with. Seeding a World's rng with seed, calling reset() and stepping it
+// through the inputs replays the game exactly.
+//
+// Inputs are packed into five bits and run-length encoded: each change is
+// stored as the input byte followed by the number of ticks it was held, as
+// a LEB128 varint. A minute of play is usually a few hundred bytes. File
+// layout, all integers little endian:
+//
+//   "TFKIINPT"  magic
+//   u32         format version
+//   u64         seed
+//   u64         tick count
+//   ...         (input byte, varint ticks) pairs up to the end of the file
+class InputLog {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t seed = 0;
+
+    static uint8_t pack(const Input& input) {
+        return (input.turnLeft << 0) | (input.turnRight << 1) | (input.thrust << 2) |
+               (input.fire << 3) | (input.fireHoming << 4);
+    }
+
+    static Input unpack(uint8_t bits) {
+        Input input;
+        input.turnLeft = bits & 1;
+        input.turnRight = bits & 2;
+        input.thrust = bits & 4;
+        input.fire = bits & 8;
+        input.fireHoming = bits & 16;
+        return input;
+    }
+
+    // Starts a new, empty log for a game reset with seed
+    void start(uint64_t newSeed) {
+        seed = newSeed;
+        runs.clear();
+        ticks = 0;
+    }
+
+    void append(const Input& input) {
+        uint8_t bits = pack(input);
+        if (runs.empty() || runs.back().bits != bits) runs.push_back({bits, 0});
+        runs.back().length++;
+        ticks++;
+    }
+
+    uint64_t tickCount() const { return ticks; }
+
+    bool save(const char* path) const {
+        std::vector<uint8_t> out;
+        out.insert(out.end(), MAGIC, MAGIC + 8);
+        putFixed(out, VERSION, 4);
+        putFixed(out, seed, 8);
+        putFixed(out, ticks, 8);
+        for (const Run& run : runs) {
+            out.push_back(run.bits);
+            putVarint(out, run.length);
+        }
+
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+        return fclose(f) == 0 && ok;
+    }
+
+    bool load(const char* path) {
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        std::vector<uint8_t> in;
+        uint8_t buffer[4096];
+        for (size_t n; (n = fread(buffer, 1, sizeof buffer, f)) > 0;) in.insert(in.end(), buffer, buffer + n);
+        fclose(f);
+
+        size_t at = 0;
+        if (in.size() < HEADER_SIZE || memcmp(in.data(), MAGIC, 8) != 0) return false;
+        at = 8;
+        if (getFixed(in, at, 4) != VERSION) return false;
+        start(getFixed(in, at, 8));
+        uint64_t expected = getFixed(in, at, 8);
+        while (at < in.size()) {
+            uint8_t bits = in[at++];
+            uint64_t length;
+            if (!getVarint(in, at, length) || length == 0) return false;
+            runs.push_back({bits, length});
+            ticks += length;
+        }
+        return ticks == expected;
+    }
+
+    // Reads the log back one tick at a time
+    class Reader {
+    public:
+        explicit Reader(const InputLog& log) : log(log) {}
+
+        bool next(Input& out) {
+            while (run < log.runs.size() && used == log.runs[run].length) {
+                run++;
+                used = 0;
+            }
+            if (run == log.runs.size()) return false;
+            used++;
+            out = unpack(log.runs[run].bits);
+            return true;
+        }
+
+    private:
+        const InputLog& log;
+        size_t run = 0;
+        uint64_t used = 0;
+    };
+
+private:
+    static constexpr char MAGIC[9] = "TFKIINPT";
+    static constexpr size_t HEADER_SIZE = 8 + 4 + 8 + 8;
+
+    struct Run {
+        uint8_t bits;
+        uint64_t length;
+    };
+
+    std::vector<Run> runs;
+    uint64_t ticks = 0;
+
+    static void putFixed(std::vector<uint8_t>& out, uint64_t v, int bytes) {
+        for (int i = 0; i < bytes; i++) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    static uint64_t getFixed(const std::vector<uint8_t>& in, size_t& at, int bytes) {
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; i++) v |= uint64_t(in[at++]) << (8 * i);
+        return v;
+    }
+
+    static void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    static bool getVarint(const std::vector<uint8_t>& in, size_t& at, uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64 && at < in.size(); shift += 7) {
+            uint8_t b = in[at++];
+            v |= uint64_t(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+};
+
+#endif // REPLAY_HPP
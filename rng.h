@@ -0,0 +1,42 @@
+#ifndef RNG_HPP
+#define RNG_HPP
+
+#include <cstdint>
+
+// The simulation's random numbers (xorshift64*). Unlike rand() the sequence
+// is the same with every C library, and each World owns its generator, so
+// nothing outside the simulation can draw from it and change the game.
+class Rng {
+public:
+    explicit Rng(uint64_t seed = 1) { this->seed(seed); }
+
+    void seed(uint64_t seed) {
+        // splitmix64, so that nearby seeds start far apart and 0 is usable
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        s = z ? z : 1;
+    }
+
+    uint32_t next() {
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        return static_cast<uint32_t>((s * 0x2545F4914F6CDD1Dull) >> 32);
+    }
+
+    // Uniform-ish integer in [0, n); n must be positive
+    int below(int n) { return static_cast<int>(next() % static_cast<uint32_t>(n)); }
+
+    // True with probability p
+    bool chance(float p) { return next() < p * 4294967296.0; }
+
+    uint64_t state() const { return s; }
+    void setState(uint64_t state) { s = state ? state : 1; }
+
+private:
+    uint64_t s;
+};
+
+#endif // RNG_HPP
@@ -0,0 +1,263 @@
+#ifndef SAVESTATE_HPP
+#define SAVESTATE_HPP
+
+#include "world.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Whole-world save states, for quick-resume, bug repros and benchmark
+// starting points. A save is taken between ticks and restores to a world
+// with the same stateHash(), which then plays on identically.
+//
+// The file is the entity columns as they sit in memory, behind a header and
+// a directory of (kind, column, element size, count, offset) entries. Every
+// column starts on a 64 byte boundary, so a mapped file can be read in
+// place, and loading is one memcpy per column. Columns the loader does not
+// know are skipped and missing ones are zero-filled, which leaves room to
+// add columns without bumping the version. Values are in the byte order of
+// the machine that wrote them; other machines refuse the file.
+
+enum class SaveColumn : uint32_t {
+    X,
+    Y,
+    DX,
+    DY,
+    Radius,
+    Angle,
+    Clip,
+    Frame,
+    AnimSpeed,
+    Life,
+    Thrust,
+    Health,
+    SpawnChildren,
+    CurrentSize,
+    DamageDealt
+};
+
+struct SaveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t fileSize;
+    uint32_t columnCount;
+    uint32_t directoryOffset;
+    uint64_t rngState;
+    int32_t bossSpawned;
+    int32_t asteroidsShotDirectly;
+    int32_t asteroidsDestroyedInExplosions;
+    int32_t maxAsteroidsDestroyed;
+    int32_t activeBossCount;
+    int32_t playerIndex; // -1 without a player
+    float shootCooldown;
+    float homingShootCooldown;
+};
+
+struct SaveColumnEntry {
+    uint32_t kind;
+    uint32_t column;
+    uint32_t elementSize;
+    uint32_t count;
+    uint64_t offset;
+};
+
+static_assert(sizeof(SaveHeader) == 72, "SaveHeader is part of the file format");
+static_assert(sizeof(SaveColumnEntry) == 24, "SaveColumnEntry is part of the file format");
+
+constexpr char SAVE_MAGIC[8] = {'T', 'F', 'K', 'I', 'S', 'A', 'V', 'E'};
+constexpr uint32_t SAVE_VERSION = 1;
+constexpr uint32_t SAVE_BYTE_ORDER = 0x01020304;
+constexpr size_t SAVE_ALIGNMENT = 64;
+
+// Most entities of one kind a save may hold. Pools grow past their
+// *_CAPACITY reserves in play, so this is a sanity limit on what a file can
+// make the loader allocate, not the reserve.
+constexpr uint32_t SAVE_MAX_ENTITIES = 1 << 20;
+
+// Calls f(kind, column, vector) for every saved column
+template <typename F>
+void forEachSavedColumn(World& world, F&& f) {
+    world.forEachKind([&](auto& arr) {
+        f(arr.kind, SaveColumn::X, arr.x);
+        f(arr.kind, SaveColumn::Y, arr.y);
+        f(arr.kind, SaveColumn::DX, arr.dx);
+        f(arr.kind, SaveColumn::DY, arr.dy);
+        f(arr.kind, SaveColumn::Radius, arr.R);
+        f(arr.kind, SaveColumn::Angle, arr.angle);
+        f(arr.kind, SaveColumn::Clip, arr.clip);
+        f(arr.kind, SaveColumn::Frame, arr.frame);
+        f(arr.kind, SaveColumn::AnimSpeed, arr.animSpeed);
+        f(arr.kind, SaveColumn::Life, arr.life);
+    });
+    f(EntityKind::Player, SaveColumn::Thrust, world.players.thrust);
+    f(EntityKind::Boss, SaveColumn::Health, world.bosses.health);
+    f(EntityKind::Boss, SaveColumn::SpawnChildren, world.bosses.spawnChildren);
+    f(EntityKind::ExplosionEffect, SaveColumn::CurrentSize, world.effects.currentSize);
+    f(EntityKind::ExplosionEffect, SaveColumn::DamageDealt, world.effects.damageDealt);
+}
+
+inline size_t alignSave(size_t offset) {
+    return (offset + SAVE_ALIGNMENT - 1) / SAVE_ALIGNMENT * SAVE_ALIGNMENT;
+}
+
+// Serializes the world into out, reusing its capacity. Only call between
+// ticks.
+inline void saveWorld(World& world, std::vector<uint8_t>& out) {
+    uint32_t columnCount = 0;
+    size_t dataSize = 0;
+    forEachSavedColumn(world, [&](EntityKind, SaveColumn, const auto& column) {
+        columnCount++;
+        dataSize = alignSave(dataSize) + column.size() * sizeof(column[0]);
+    });
+
+    size_t directoryOffset = sizeof(SaveHeader);
+    size_t offset = alignSave(directoryOffset + columnCount * sizeof(SaveColumnEntry));
+    out.assign(offset + dataSize, 0);
+
+    SaveHeader header;
+    memcpy(header.magic, SAVE_MAGIC, sizeof header.magic);
+    header.version = SAVE_VERSION;
+    header.byteOrder = SAVE_BYTE_ORDER;
+    header.fileSize = out.size();
+    header.columnCount = columnCount;
+    header.directoryOffset = static_cast<uint32_t>(directoryOffset);
+    header.rngState = world.rng.state();
+    header.bossSpawned = world.bossSpawned;
+    header.asteroidsShotDirectly = world.asteroidsShotDirectly;
+    header.asteroidsDestroyedInExplosions = world.asteroidsDestroyedInExplosions;
+    header.maxAsteroidsDestroyed = world.maxAsteroidsDestroyed;
+    header.activeBossCount = world.activeBossCount;
+    header.playerIndex = world.players.find(world.player);
+    header.shootCooldown = world.shootCooldown;
+    header.homingShootCooldown = world.homingShootCooldown;
+    memcpy(out.data(), &header, sizeof header);
+
+    size_t entry = directoryOffset;
+    forEachSavedColumn(world, [&](EntityKind kind, SaveColumn id, const auto& column) {
+        offset = alignSave(offset);
+        SaveColumnEntry e{static_cast<uint32_t>(kind), static_cast<uint32_t>(id),
+                          static_cast<uint32_t>(sizeof(column[0])), static_cast<uint32_t>(column.size()), offset};
+        memcpy(out.data() + entry, &e, sizeof e);
+        entry += sizeof e;
+        if (!column.empty()) memcpy(out.data() + offset, column.data(), column.size() * sizeof(column[0]));
+        offset += column.size() * sizeof(column[0]);
+    });
+}
+
+// Replaces the world with the save in data, which may point into a mapped
+// file. On failure the world is left untouched.
+inline bool loadWorld(World& world, const uint8_t* data, size_t size) {
+    SaveHeader header;
+    if (size < sizeof header) return false;
+    memcpy(&header, data, sizeof header);
+    if (memcmp(header.magic, SAVE_MAGIC, sizeof header.magic) != 0 || header.version != SAVE_VERSION ||
+        header.byteOrder != SAVE_BYTE_ORDER || header.fileSize > size) {
+        return false;
+    }
+    size_t directoryEnd = header.directoryOffset + size_t(header.columnCount) * sizeof(SaveColumnEntry);
+    if (directoryEnd > size) return false;
+
+    auto findColumn = [&](EntityKind kind, SaveColumn id, SaveColumnEntry& out) {
+        for (uint32_t i = 0; i < header.columnCount; i++) {
+            memcpy(&out, data + header.directoryOffset + i * sizeof out, sizeof out);
+            if (out.kind == static_cast<uint32_t>(kind) && out.column == static_cast<uint32_t>(id)) return true;
+        }
+        return false;
+    };
+
+    // Check everything before touching the world: sizes, bounds, and that
+    // all columns of a kind hold the same number of entities
+    size_t counts[KIND_COUNT] = {};
+    bool seen[KIND_COUNT] = {};
+    bool valid = true;
+    forEachSavedColumn(world, [&](EntityKind kind, SaveColumn id, const auto& column) {
+        SaveColumnEntry e;
+        if (!findColumn(kind, id, e)) return;
+        int k = static_cast<int>(kind);
+        if (e.elementSize != sizeof(column[0]) || e.count > SAVE_MAX_ENTITIES || e.offset > size ||
+            uint64_t(e.count) * e.elementSize > size - e.offset || (seen[k] && counts[k] != e.count)) {
+            valid = false;
+        }
+        seen[k] = true;
+        counts[k] = e.count;
+    });
+    SaveColumnEntry clips;
+    if (!valid || (header.playerIndex >= 0 && size_t(header.playerIndex) >= counts[static_cast<int>(EntityKind::Player)])) {
+        return false;
+    }
+    for (int k = 0; k < KIND_COUNT; k++) {
+        if (!findColumn(static_cast<EntityKind>(k), SaveColumn::Clip, clips)) continue;
+        for (uint32_t i = 0; i < clips.count; i++) {
+            if (data[clips.offset + i] >= CLIP_COUNT) return false;
+        }
+    }
+    // Frames index the clip's frame list when drawn. Clips without frames
+    // keep frame 0.
+    for (int k = 0; k < KIND_COUNT; k++) {
+        SaveColumnEntry frames;
+        EntityKind kind = static_cast<EntityKind>(k);
+        if (!findColumn(kind, SaveColumn::Frame, frames)) continue;
+        bool haveClips = findColumn(kind, SaveColumn::Clip, clips);
+        for (uint32_t i = 0; i < frames.count; i++) {
+            float frame;
+            memcpy(&frame, data + frames.offset + i * sizeof frame, sizeof frame);
+            ClipId clip = haveClips ? static_cast<ClipId>(data[clips.offset + i]) : ClipId::None;
+            if (!(frame >= 0 && frame < std::max(clipTiming(clip).frameCount, 1))) return false;
+        }
+    }
+
+    world.clear();
+    forEachSavedColumn(world, [&](EntityKind kind, SaveColumn id, auto& column) {
+        using T = typename std::decay_t<decltype(column)>::value_type;
+        column.assign(counts[static_cast<int>(kind)], T());
+        SaveColumnEntry e;
+        if (findColumn(kind, id, e) && e.count > 0) memcpy(column.data(), data + e.offset, e.count * sizeof(T));
+    });
+    world.forEachKind([](auto& arr) {
+        arr.rebuildSlots();
+        // Speeds always follow from the clip; the saved ones are not
+        // trusted, as a bad one would run frames past the clip's end
+        for (size_t i = 0; i < arr.size(); i++) arr.animSpeed[i] = clipTiming(arr.clip[i]).speed * TICK_DT;
+    });
+
+    world.rng.setState(header.rngState);
+    world.bossSpawned = header.bossSpawned != 0;
+    world.asteroidsShotDirectly = header.asteroidsShotDirectly;
+    world.asteroidsDestroyedInExplosions = header.asteroidsDestroyedInExplosions;
+    world.maxAsteroidsDestroyed = header.maxAsteroidsDestroyed;
+    world.activeBossCount = header.activeBossCount;
+    world.shootCooldown = header.shootCooldown;
+    world.homingShootCooldown = header.homingShootCooldown;
+    world.player = header.playerIndex >= 0 ? world.players.handle(header.playerIndex) : EntityHandle();
+    return true;
+}
+
+inline bool saveWorldFile(World& world, const char* path) {
+    std::vector<uint8_t> bytes;
+    saveWorld(world, bytes);
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    return fclose(f) == 0 && ok;
+}
+
+inline bool loadWorldFile(World& world, const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    std::vector<uint8_t> bytes;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        long size = ftell(f);
+        if (size > 0 && fseek(f, 0, SEEK_SET) == 0) {
+            bytes.resize(size);
+            bytes.resize(fread(bytes.data(), 1, bytes.size(), f));
+        }
+    }
+    fclose(f);
+    return loadWorld(world, bytes.data(), bytes.size());
+}
+
+#endif // SAVESTATE_HPP
@@ -0,0 +1,286 @@
+#ifndef SCORES_HPP
+#define SCORES_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+struct ScoreEntry {
+    int score;
+    int64_t time; // seconds since the epoch
+};
+
+// High scores kept across runs. Every finished round is appended to a log
+// file and synced to disk, so a crash loses at most the round being
+// written; a torn record at the end fails its checksum and is dropped. When
+// the log grows past COMPACT_AFTER records, or holds a torn record, it is
+// rewritten with only the best KEPT_SCORES to a temporary file that is
+// synced and renamed over the log, so there is always one whole log on
+// disk. All file work happens on the store's own thread: start() returns
+// at once, and record() and fetch() never wait on the disk.
+//
+// File layout, all integers little endian:
+//
+//   "TFKISCOR"  magic
+//   u32         format version
+//   u32         reserved, 0
+//   ...         16 byte records: i32 score, i64 time, u32 FNV-1a checksum
+//               of the twelve bytes before it
+class ScoreStore {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t KEPT_SCORES = 100;
+    static constexpr size_t COMPACT_AFTER = 1000;
+
+    ScoreStore() = default;
+    ~ScoreStore() { stop(); }
+
+    ScoreStore(const ScoreStore&) = delete;
+    ScoreStore& operator=(const ScoreStore&) = delete;
+
+    // Loads the log at logPath in the background
+    void start(const std::string& logPath) {
+        path = logPath;
+        stopping = false;
+        thread = std::thread([this] { run(); });
+    }
+
+    // Writes out every score recorded so far, then ends the thread
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (thread.joinable()) thread.join();
+    }
+
+    // Any thread. Rounds without a point are not worth keeping.
+    void record(int score) {
+        if (score <= 0) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queued.push_back({score, static_cast<int64_t>(::time(nullptr))});
+        }
+        wake.notify_one();
+    }
+
+    // Copies the best scores, highest first, into out and returns true if
+    // they changed since the last call. The first true comes once the log
+    // has been read.
+    bool fetch(std::vector<ScoreEntry>& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (version == fetched) return false;
+        fetched = version;
+        out = published;
+        return true;
+    }
+
+private:
+    static constexpr char MAGIC[9] = "TFKISCOR";
+    static constexpr size_t HEADER_SIZE = 16;
+    static constexpr size_t RECORD_SIZE = 16;
+
+    std::string path;
+    std::thread thread;
+
+    // Shared with the other threads
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<ScoreEntry> queued;
+    std::vector<ScoreEntry> published;
+    bool stopping = false;
+    int version = 0;
+    int fetched = 0;
+
+    // Store thread only
+    std::vector<ScoreEntry> best;
+    size_t logRecords = 0;
+    bool haveHeader = false;
+    bool writable = true;
+
+    void run() {
+        bool torn = load();
+        if (writable && (torn || logRecords > COMPACT_AFTER)) compact();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        publish();
+        for (;;) {
+            wake.wait(lock, [this] { return stopping || !queued.empty(); });
+            if (queued.empty()) break;
+            std::vector<ScoreEntry> batch;
+            batch.swap(queued);
+            lock.unlock();
+
+            for (const ScoreEntry& entry : batch) {
+                if (writable) append(entry);
+                insert(entry);
+            }
+            if (writable && logRecords > COMPACT_AFTER) compact();
+
+            lock.lock();
+            publish();
+        }
+    }
+
+    // Called with the mutex held
+    void publish() {
+        published = best;
+        version++;
+    }
+
+    void insert(const ScoreEntry& entry) {
+        auto at = std::upper_bound(best.begin(), best.end(), entry, higher);
+        best.insert(at, entry);
+        if (best.size() > KEPT_SCORES) best.pop_back();
+    }
+
+    static bool higher(const ScoreEntry& a, const ScoreEntry& b) { return a.score > b.score; }
+
+    // Reads the log into best. Returns true if it ended in a torn or
+    // corrupt record, or a torn header, that a rewrite should clear.
+    bool load() {
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) return false;
+        std::vector<uint8_t> in;
+        uint8_t buffer[4096];
+        for (size_t n; (n = fread(buffer, 1, sizeof buffer, f)) > 0;) in.insert(in.end(), buffer, buffer + n);
+        fclose(f);
+
+        if (in.size() < HEADER_SIZE) return !in.empty();
+        if (!std::equal(MAGIC, MAGIC + 8, in.begin()) || getFixed(in.data() + 8, 4) != VERSION) {
+            // Not a log this version can extend; leave it alone
+            fprintf(stderr, "Not a score log: %s, scores will not be saved\n", path.c_str());
+            writable = false;
+            return false;
+        }
+        haveHeader = true;
+
+        bool torn = false;
+        size_t at = HEADER_SIZE;
+        for (; at + RECORD_SIZE <= in.size(); at += RECORD_SIZE) {
+            const uint8_t* record = in.data() + at;
+            if (getFixed(record + 12, 4) != checksum(record)) {
+                torn = true;
+                continue;
+            }
+            best.push_back({static_cast<int32_t>(getFixed(record, 4)), static_cast<int64_t>(getFixed(record + 4, 8))});
+            logRecords++;
+        }
+        std::stable_sort(best.begin(), best.end(), higher);
+        if (best.size() > KEPT_SCORES) best.resize(KEPT_SCORES);
+        return torn || at != in.size();
+    }
+
+    void append(const ScoreEntry& entry) {
+        FILE* f = fopen(path.c_str(), "ab");
+        if (!f) {
+            fprintf(stderr, "Failed to open %s, score not saved\n", path.c_str());
+            return;
+        }
+        std::vector<uint8_t> out;
+        if (!haveHeader) putHeader(out);
+        putRecord(out, entry);
+        bool ok = fwrite(out.data(), 1, out.size(), f) == out.size() && sync(f);
+        ok = fclose(f) == 0 && ok;
+        if (!ok) {
+            fprintf(stderr, "Failed to write %s, score may not be saved\n", path.c_str());
+            return;
+        }
+        haveHeader = true;
+        logRecords++;
+    }
+
+    // Writes best to a new file and renames it over the log. Until the
+    // rename the old log is untouched; after it the new one is complete.
+    void compact() {
+        std::string temporary = path + ".tmp";
+        std::vector<uint8_t> out;
+        putHeader(out);
+        for (const ScoreEntry& entry : best) putRecord(out, entry);
+
+        FILE* f = fopen(temporary.c_str(), "wb");
+        if (!f) return;
+        bool ok = fwrite(out.data(), 1, out.size(), f) == out.size() && sync(f);
+        ok = fclose(f) == 0 && ok;
+        if (!ok || !replace(temporary, path)) {
+            fprintf(stderr, "Failed to compact %s\n", path.c_str());
+            remove(temporary.c_str());
+            return;
+        }
+        haveHeader = true;
+        logRecords = best.size();
+    }
+
+    static bool sync(FILE* f) {
+        if (fflush(f) != 0) return false;
+#ifdef _WIN32
+        return _commit(_fileno(f)) == 0;
+#else
+        return fsync(fileno(f)) == 0;
+#endif
+    }
+
+    // Atomically replaces to with from, then makes the rename itself durable
+    static bool replace(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+        return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        if (rename(from.c_str(), to.c_str()) != 0) return false;
+        size_t slash = to.find_last_of('/');
+        std::string directory = slash == std::string::npos ? "." : to.substr(0, slash + 1);
+        int fd = open(directory.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            fsync(fd);
+            close(fd);
+        }
+        return true;
+#endif
+    }
+
+    static uint32_t checksum(const uint8_t* bytes) {
+        uint32_t hash = 2166136261u;
+        for (int i = 0; i < 12; i++) hash = (hash ^ bytes[i]) * 16777619u;
+        return hash;
+    }
+
+    static void putHeader(std::vector<uint8_t>& out) {
+        out.insert(out.end(), MAGIC, MAGIC + 8);
+        putFixed(out, VERSION, 4);
+        putFixed(out, 0, 4);
+    }
+
+    static void putRecord(std::vector<uint8_t>& out, const ScoreEntry& entry) {
+        size_t start = out.size();
+        putFixed(out, static_cast<uint32_t>(entry.score), 4);
+        putFixed(out, static_cast<uint64_t>(entry.time), 8);
+        putFixed(out, checksum(out.data() + start), 4);
+    }
+
+    static void putFixed(std::vector<uint8_t>& out, uint64_t v, int bytes) {
+        for (int i = 0; i < bytes; i++) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    static uint64_t getFixed(const uint8_t* in, int bytes) {
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; i++) v |= uint64_t(in[i]) << (8 * i);
+        return v;
+    }
+};
+
+#endif // SCORES_HPP
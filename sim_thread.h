@@ -0,0 +1,173 @@
+#ifndef SIM_THREAD_HPP
+#define SIM_THREAD_HPP
+
+#include "world.h"
+#include "snapshot.h"
+#include "replay.h"
+#include "savestate.h"
+#include "scores.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// Runs World::step() on its own thread at the tick rate, independent of how
+// long drawing or display() takes, and publishes a Snapshot after every
+// batch of ticks. The game thread only talks to it through the calls below;
+// once start()ed, nothing else may touch the World until stop().
+class SimulationThread {
+public:
+    TripleBuffer<Snapshot> snapshots;
+
+    // When set before start(), every round's seed and per-tick input are
+    // written here; the log restarts with each reset
+    InputLog* recording = nullptr;
+
+    // When set, the score of every round that ends in a crash is recorded
+    ScoreStore* scores = nullptr;
+
+    explicit SimulationThread(World& world) : world(world) {}
+
+    ~SimulationThread() { stop(); }
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    void start() {
+        stopping = false;
+        thread = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        stopping = true;
+        if (thread.joinable()) thread.join();
+    }
+
+    // Held keys replace the previous input; a homing shot requested since
+    // the last tick is kept until a tick has consumed it
+    void setInput(const Input& input) {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        bool fireHoming = pending.fireHoming;
+        pending = input;
+        pending.fireHoming = fireHoming || input.fireHoming;
+    }
+
+    // Ticks only run while running; the menu and the pause screen stop them
+    void setRunning(bool value) { running = value; }
+
+    // Starts a new round before the next tick
+    void requestReset() { resetRequested = true; }
+
+    // Saves the world to, or replaces it from, a save-state file before the
+    // next tick. path must stay valid until then. Loading is refused while
+    // recording, since the log could not replay the loaded world.
+    void requestSave(const char* path) { savePath = path; }
+    void requestLoad(const char* path) { loadPath = path; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int MAX_CATCH_UP_TICKS = 5;
+
+    World& world;
+    std::thread thread;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> running{false};
+    std::atomic<bool> resetRequested{false};
+    std::atomic<const char*> savePath{nullptr};
+    std::atomic<const char*> loadPath{nullptr};
+
+    std::mutex inputMutex;
+    Input pending;
+
+    PoseRecord before;
+    long tick = 0;
+    int loads = 0;
+
+    Input takeInput() {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        Input input = pending;
+        pending.fireHoming = false;
+        return input;
+    }
+
+    // Fixed-step loop: real time goes into an accumulator and whole ticks
+    // are taken out of it. After a stall at most MAX_CATCH_UP_TICKS are run
+    // back to back and the rest of the backlog is dropped, so the game
+    // slows down briefly instead of spiralling.
+    void run() {
+        const auto tickLength = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(TICK_DT));
+        Clock::duration accumulator{0};
+        Clock::time_point last = Clock::now();
+        while (!stopping) {
+            Clock::time_point now = Clock::now();
+            accumulator = std::min(accumulator + (now - last), tickLength * MAX_CATCH_UP_TICKS);
+            last = now;
+
+            if (resetRequested.exchange(false)) {
+                // Each round gets its own seed, so a recording needs
+                // nothing from before it started
+                uint64_t seed = world.rng.next();
+                world.rng.seed(seed);
+                if (recording) recording->start(seed);
+                world.reset();
+                before.x.clear();
+                publish(now);
+            }
+            if (const char* path = savePath.exchange(nullptr)) {
+                if (!saveWorldFile(world, path)) fprintf(stderr, "Failed to save %s\n", path);
+            }
+            if (const char* path = loadPath.exchange(nullptr)) {
+                if (recording) {
+                    fprintf(stderr, "Not loading %s while recording input\n", path);
+                } else if (loadWorldFile(world, path)) {
+                    loads++;
+                    before.x.clear();
+                    publish(now);
+                } else {
+                    fprintf(stderr, "Failed to load %s\n", path);
+                }
+            }
+            if (!running) {
+                accumulator = Clock::duration{0};
+            } else if (accumulator >= tickLength) {
+                while (accumulator >= tickLength) {
+                    stepOnce();
+                    accumulator -= tickLength;
+                }
+                // The state is now that of time now - accumulator; the
+                // renderer interpolates forward from there
+                publish(now - accumulator);
+            }
+
+            std::this_thread::sleep_until(now + (tickLength - accumulator));
+        }
+    }
+
+    void stepOnce() {
+        Snapshot& out = snapshots.back();
+        Input input = takeInput();
+        if (recording) recording->append(input);
+        int roundsEnded = world.roundsEnded;
+        world.step(input, [&](Phase phase, auto&& run) {
+            if (phase == Phase::Update) before.record(world);
+            Clock::time_point start = Clock::now();
+            run();
+            out.phaseMicros[static_cast<int>(phase)] =
+                std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        });
+        if (scores && world.roundsEnded != roundsEnded) scores->record(world.lastRoundScore);
+        tick++;
+    }
+
+    void publish(Clock::time_point stateTime) {
+        Snapshot& out = snapshots.back();
+        captureSnapshot(world, before, out);
+        out.tick = tick;
+        out.loads = loads;
+        out.time = stateTime;
+        snapshots.publish();
+    }
+};
+
+#endif // SIM_THREAD_HPP
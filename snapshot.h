@@ -0,0 +1,153 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include "world.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Everything the renderer needs from one simulation tick, copied out of the
+// World so drawing never touches live simulation state.
+
+// One entity sprite. step is how far the entity moved during the tick, so
+// the renderer can draw it anywhere between its previous and current pose.
+struct SpriteState {
+    ClipId clip;
+    int frame;
+    float x, y, angle;
+    float stepX, stepY, stepAngle;
+};
+
+struct BossBarState {
+    float x, y;
+    float stepX, stepY;
+    int health;
+};
+
+struct EffectState {
+    float x, y, size;
+};
+
+struct Snapshot {
+    using Clock = std::chrono::steady_clock;
+
+    long tick = 0;
+    Clock::time_point time; // when this state was current in real time
+
+    // Sprites in draw order: kinds in World::forEachKind() order
+    std::vector<SpriteState> sprites;
+    std::vector<BossBarState> bossBars;
+    std::vector<EffectState> effects;
+
+    int score = 0;
+    int highScore = 0;
+    int poolGrowths = 0;
+    int loads = 0; // save states loaded into the world so far
+    size_t kindCounts[KIND_COUNT] = {};
+
+    // Phase timings of the last tick, in microseconds
+    long phaseMicros[PHASE_COUNT] = {};
+
+    Snapshot() {
+        sprites.reserve(ASTEROID_CAPACITY + BOSS_CAPACITY + BULLET_CAPACITY + HOMING_BULLET_CAPACITY +
+                        EXPLOSION_CAPACITY + PLAYER_CAPACITY);
+        bossBars.reserve(BOSS_CAPACITY);
+        effects.reserve(EXPLOSION_EFFECT_CAPACITY);
+    }
+
+    // How far the renderer is between the previous tick and this one, 0..1
+    float alpha(Clock::time_point now) const {
+        float a = std::chrono::duration<float>(now - time).count() / TICK_DT;
+        return a < 0 ? 0 : a > 1 ? 1 : a;
+    }
+};
+
+// Positions of every entity before the motion update, in forEachKind()
+// order. The entity arrays keep their layout from the commit phase to the
+// end of the tick, so entity n here is entity n at capture time.
+struct PoseRecord {
+    std::vector<float> x, y, angle;
+
+    void record(World& world) {
+        x.clear();
+        y.clear();
+        angle.clear();
+        world.forEachKind([&](const EntityArrays& arr) {
+            x.insert(x.end(), arr.x.begin(), arr.x.end());
+            y.insert(y.end(), arr.y.begin(), arr.y.end());
+            angle.insert(angle.end(), arr.angle.begin(), arr.angle.end());
+        });
+    }
+};
+
+// Fills out from the world's current state. Movement that wrapped around a
+// screen edge is not interpolated, the entity just appears on the other side.
+inline void captureSnapshot(World& world, const PoseRecord& before, Snapshot& out) {
+    out.sprites.clear();
+    out.bossBars.clear();
+    out.effects.clear();
+
+    size_t n = 0;
+    world.forEachKind([&](const EntityArrays& arr) {
+        out.kindCounts[static_cast<int>(arr.kind)] = arr.size();
+        for (size_t i = 0; i < arr.size(); i++, n++) {
+            if (!arr.life[i] || arr.clip[i] == ClipId::None) continue;
+            SpriteState s{arr.clip[i], int(arr.frame[i]), arr.x[i], arr.y[i], arr.angle[i], 0, 0, 0};
+            if (n < before.x.size()) {
+                s.stepX = arr.x[i] - before.x[n];
+                s.stepY = arr.y[i] - before.y[n];
+                s.stepAngle = arr.angle[i] - before.angle[n];
+                if (std::fabs(s.stepX) > W / 2 || std::fabs(s.stepY) > H / 2) s.stepX = s.stepY = 0;
+            }
+            out.sprites.push_back(s);
+            if (arr.kind == EntityKind::Boss) {
+                out.bossBars.push_back({s.x, s.y, s.stepX, s.stepY, world.bosses.health[i]});
+            }
+        }
+    });
+
+    const EffectArrays& effects = world.effects;
+    for (size_t i = 0; i < effects.size(); i++) {
+        if (effects.life[i]) out.effects.push_back({effects.x[i], effects.y[i], effects.currentSize[i]});
+    }
+
+    out.score = world.score();
+    out.highScore = world.maxAsteroidsDestroyed;
+    out.poolGrowths = world.poolGrowths();
+}
+
+// Lock-free triple buffer with one writer and one reader. The writer fills
+// back() and publish()es it; the reader calls acquire() and draws front().
+// Neither side ever waits for the other, and the reader always gets the
+// newest published value; values it was too slow to see are skipped.
+template <typename T>
+class TripleBuffer {
+public:
+    T& back() { return slots[backIndex]; }
+
+    void publish() {
+        backIndex = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Swaps in the newest published value, if there is one since the last
+    // call. Returns whether front() changed.
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static constexpr unsigned INDEX = 3;
+    static constexpr unsigned FRESH = 4;
+
+    T slots[3];
+    unsigned backIndex = 0;
+    std::atomic<unsigned> middle{1};
+    unsigned frontIndex = 2;
+};
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,125 @@
+#ifndef SPRITE_BATCH_HPP
+#define SPRITE_BATCH_HPP
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cmath>
+
+// Collects rotated, textured quads and submits each run of consecutive
+// quads that share a texture with a single draw call. A texture change
+// starts a new run, so sprites layer exactly in the order they were added.
+class SpriteBatch {
+public:
+    void begin() {
+        for (Batch& batch : batches) batch.vertices.clear();
+        used = 0;
+    }
+
+    // Queues a sprite centred on (x, y), rotated by angle degrees
+    void add(const sf::Texture* texture, const sf::IntRect& rect,
+             float x, float y, float angle, float scale,
+             sf::Color color = sf::Color::White) {
+        sf::VertexArray& vertices = batchFor(texture).vertices;
+
+        float hw = rect.width * 0.5f * scale;
+        float hh = rect.height * 0.5f * scale;
+        float rad = angle * 3.14159265f / 180;
+        float c = std::cos(rad);
+        float s = std::sin(rad);
+
+        float u0 = rect.left, v0 = rect.top;
+        float u1 = u0 + rect.width, v1 = v0 + rect.height;
+
+        auto corner = [&](float ox, float oy, float u, float v) {
+            vertices.append(sf::Vertex(sf::Vector2f(x + ox * c - oy * s, y + ox * s + oy * c),
+                                       color, sf::Vector2f(u, v)));
+        };
+        corner(-hw, -hh, u0, v0);
+        corner(hw, -hh, u1, v0);
+        corner(hw, hh, u1, v1);
+        corner(-hw, hh, u0, v1);
+    }
+
+    void draw(sf::RenderTarget& target) {
+        calls = 0;
+        for (size_t i = 0; i < used; i++) {
+            Batch& batch = batches[i];
+            target.draw(batch.vertices, sf::RenderStates(batch.texture));
+            calls++;
+        }
+    }
+
+    // Draw calls issued by the last draw()
+    int drawCalls() const { return calls; }
+
+private:
+    struct Batch {
+        const sf::Texture* texture;
+        sf::VertexArray vertices;
+    };
+
+    // Batches persist between frames so their vertex storage is reused
+    std::vector<Batch> batches;
+    size_t used = 0; // batches holding this frame's runs, in draw order
+    int calls = 0;
+
+    Batch& batchFor(const sf::Texture* texture) {
+        if (used > 0 && batches[used - 1].texture == texture) return batches[used - 1];
+        if (used == batches.size()) batches.push_back({texture, sf::VertexArray(sf::Quads)});
+        Batch& batch = batches[used++];
+        batch.texture = texture;
+        return batch;
+    }
+};
+
+// Filled circles with an outline, all drawn from one triangle list in a
+// single draw call. Looks like an sf::CircleShape with the same point
+// count, whose outline also sits outside the radius.
+class CircleBatch {
+public:
+    static constexpr int POINTS = 30;
+
+    CircleBatch() {
+        for (int i = 0; i < POINTS; i++) {
+            float a = i * 2 * 3.14159265f / POINTS;
+            unitX[i] = std::cos(a);
+            unitY[i] = std::sin(a);
+        }
+    }
+
+    void begin() {
+        vertices.clear();
+    }
+
+    void add(float x, float y, float radius, sf::Color fill, sf::Color outline, float outlineThickness) {
+        float outer = radius + outlineThickness;
+        for (int i = 0; i < POINTS; i++) {
+            int j = (i + 1) % POINTS;
+            sf::Vector2f in0(x + unitX[i] * radius, y + unitY[i] * radius);
+            sf::Vector2f in1(x + unitX[j] * radius, y + unitY[j] * radius);
+            sf::Vector2f out0(x + unitX[i] * outer, y + unitY[i] * outer);
+            sf::Vector2f out1(x + unitX[j] * outer, y + unitY[j] * outer);
+
+            vertices.append(sf::Vertex(sf::Vector2f(x, y), fill));
+            vertices.append(sf::Vertex(in0, fill));
+            vertices.append(sf::Vertex(in1, fill));
+
+            vertices.append(sf::Vertex(in0, outline));
+            vertices.append(sf::Vertex(out0, outline));
+            vertices.append(sf::Vertex(out1, outline));
+            vertices.append(sf::Vertex(in0, outline));
+            vertices.append(sf::Vertex(out1, outline));
+            vertices.append(sf::Vertex(in1, outline));
+        }
+    }
+
+    void draw(sf::RenderTarget& target) const {
+        if (vertices.getVertexCount() > 0) target.draw(vertices);
+    }
+
+private:
+    float unitX[POINTS], unitY[POINTS];
+    sf::VertexArray vertices{sf::Triangles};
+};
+
+#endif // SPRITE_BATCH_HPP
@@ -0,0 +1,1239 @@
+#ifndef WORLD_HPP
+#define WORLD_HPP
+
+#include "grid.h"
+#include "motion.h"
+#include "narrowphase.h"
+#include "jobs.h"
+#include "spsc_queue.h"
+#include "rng.h"
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+// The simulation. Deliberately free of SFML so it can run headless.
+
+// Game constants
+constexpr int W = 1200;
+constexpr int H = 800;
+constexpr float DEGTORAD = 0.017453f;
+constexpr int BOSS_TRIGGER_SCORE = 25;
+constexpr int MAX_BOSS_ASTEROIDS = 8;
+constexpr int INITIAL_ASTEROIDS = 15;
+constexpr int BOSS_SPAWN_COUNT = 4;
+constexpr int REGULAR_BULLET_DAMAGE = 1;
+constexpr int HOMING_BULLET_DAMAGE = 5;
+constexpr int BOSS_MAX_HEALTH = 15;
+constexpr int GRID_CELL_SIZE = 50; // divides W and H so the cells tile the playfield
+constexpr float EXPLOSION_EFFECT_RADIUS = 100;
+
+// Simulation timing. step() always advances the world by TICK_DT seconds,
+// and every rate below is per second, so changing TICK_RATE changes how
+// finely the game is simulated but not how it plays.
+constexpr int TICK_RATE = 60;
+constexpr float TICK_DT = 1.0f / TICK_RATE;
+constexpr float SHOOT_COOLDOWN = 0.15f;
+constexpr float HOMING_SHOOT_COOLDOWN = 1.5f;
+
+// Movement, in pixels and degrees per second
+constexpr float PLAYER_TURN_SPEED = 180;
+constexpr float PLAYER_THRUST = 720;         // pixels per second squared
+constexpr float PLAYER_DRAG = 0.547f;        // speed kept per second while coasting
+constexpr float PLAYER_MAX_SPEED = 300;
+constexpr float BULLET_SPEED = 360;
+constexpr float HOMING_TURN_RATE = 6;        // fraction of the heading error closed per second
+constexpr float ASTEROID_SPEED_STEP = 60;    // asteroid speeds are random multiples of this
+constexpr float BOSS_SPEED_STEP = 30;
+constexpr float BOSS_SPEED_SCALE = 0.3f;     // bosses move at this fraction of their velocity
+constexpr float EXPLOSION_EFFECT_GROWTH = 150;
+
+// Mean random spawns per second
+constexpr float BOSS_SPAWN_RATE = 0.6f;
+constexpr float ASTEROID_SPAWN_RATE = 0.4f;
+
+// Entity pool capacities, reserved up front so spawning never allocates.
+// Pools still grow past these if they have to; World::poolGrowths() counts it.
+constexpr int PLAYER_CAPACITY = 1;
+constexpr int ASTEROID_CAPACITY = 1024;
+constexpr int BOSS_CAPACITY = 2 * MAX_BOSS_ASTEROIDS;
+constexpr int BULLET_CAPACITY = 256;
+constexpr int HOMING_BULLET_CAPACITY = 32;
+constexpr int EXPLOSION_CAPACITY = 512;
+constexpr int EXPLOSION_EFFECT_CAPACITY = 64;
+
+// Entity kinds. Also used as indices into the collision response table,
+// so keep Count last.
+enum class EntityKind : unsigned char {
+    Player,
+    Asteroid,
+    Boss,
+    Bullet,
+    HomingBullet,
+    Explosion,
+    ExplosionEffect,
+    Count
+};
+
+constexpr int KIND_COUNT = static_cast<int>(EntityKind::Count);
+
+constexpr unsigned kindBit(EntityKind k) {
+    return 1u << static_cast<unsigned>(k);
+}
+
+// Kind masks for kindIn()
+constexpr unsigned ROCK_KINDS = kindBit(EntityKind::Asteroid) | kindBit(EntityKind::Boss);
+constexpr unsigned BULLET_KINDS = kindBit(EntityKind::Bullet) | kindBit(EntityKind::HomingBullet);
+
+constexpr bool kindIn(EntityKind k, unsigned kindMask) {
+    return (kindBit(k) & kindMask) != 0;
+}
+
+// Animation clips, indices into CLIP_TIMINGS and the renderer's clips table
+enum class ClipId : unsigned char {
+    None,
+    Explosion,
+    Rock,
+    RockSmall,
+    Bullet,
+    HomingBullet,
+    Player,
+    PlayerGo,
+    ExplosionShip,
+    BossRock,
+    BossExplosion,
+    Count
+};
+
+constexpr int CLIP_COUNT = static_cast<int>(ClipId::Count);
+
+// Frame count and playback speed (frames per second) of each clip. This is
+// all the simulation needs to know about animations; frame rects live with
+// the renderer.
+struct ClipTiming {
+    int frameCount;
+    float speed;
+
+    void advance(float& frame, float frameSpeed) const {
+        frame += frameSpeed;
+        if (frame >= frameCount) frame -= frameCount;
+    }
+
+    bool isEnd(float frame, float frameSpeed) const {
+        return frame + frameSpeed >= frameCount;
+    }
+};
+
+constexpr ClipTiming CLIP_TIMINGS[CLIP_COUNT] = {
+    {0, 0},  // None
+    {48, 30}, // Explosion
+    {16, 12}, // Rock
+    {16, 12}, // RockSmall
+    {16, 48}, // Bullet
+    {16, 48}, // HomingBullet
+    {1, 0},  // Player
+    {1, 0},  // PlayerGo
+    {64, 30}, // ExplosionShip
+    {16, 12}, // BossRock
+    {64, 30}, // BossExplosion
+};
+
+inline const ClipTiming& clipTiming(ClipId id) {
+    return CLIP_TIMINGS[static_cast<int>(id)];
+}
+
+
+// Stable reference to an entity. Dense indices move when entities are
+// removed; a handle goes through the slot table instead and stops resolving
+// once its entity is gone (the slot's generation no longer matches).
+struct EntityHandle {
+    EntityKind kind = EntityKind::Count;
+    uint32_t slot = 0;
+    uint32_t generation = 0;
+};
+
+// Position of an entity inside its kind's dense arrays. Only valid until the
+// next World::removeDead().
+struct EntityRef {
+    EntityKind kind;
+    uint32_t index;
+};
+
+// Structure-of-arrays storage for every entity of one kind. The arrays stay
+// dense: compact() squeezes out the dead entities, keeping the rest in order.
+class EntityArrays {
+public:
+    EntityKind kind;
+    std::vector<float> x, y, dx, dy, R, angle; // dx, dy in pixels per second
+    std::vector<ClipId> clip;       // ClipId::None if not drawn as a sprite
+    std::vector<float> frame;       // playback position in the clip
+    std::vector<float> animSpeed;   // frames advanced per tick
+    std::vector<uint8_t> life;
+
+    explicit EntityArrays(EntityKind kind) : kind(kind) {}
+
+    size_t size() const { return x.size(); }
+
+    // Number of times an add() had to reallocate the columns
+    int growths() const { return growthCount; }
+
+    void reserve(size_t capacity) {
+        slots.reserve(capacity);
+        denseIndex.reserve(capacity);
+        generations.reserve(capacity);
+        freeSlots.reserve(capacity);
+        x.reserve(capacity);
+        y.reserve(capacity);
+        dx.reserve(capacity);
+        dy.reserve(capacity);
+        R.reserve(capacity);
+        angle.reserve(capacity);
+        clip.reserve(capacity);
+        frame.reserve(capacity);
+        animSpeed.reserve(capacity);
+        life.reserve(capacity);
+    }
+
+    size_t add(ClipId c, float X, float Y, float Angle, float radius) {
+        if (x.size() == x.capacity()) growthCount++;
+
+        uint32_t s;
+        if (!freeSlots.empty()) {
+            s = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            s = static_cast<uint32_t>(generations.size());
+            generations.push_back(0);
+            denseIndex.push_back(0);
+        }
+
+        size_t i = size();
+        denseIndex[s] = static_cast<uint32_t>(i);
+        slots.push_back(s);
+        x.push_back(X);
+        y.push_back(Y);
+        dx.push_back(0);
+        dy.push_back(0);
+        R.push_back(radius);
+        angle.push_back(Angle);
+        clip.push_back(c);
+        frame.push_back(0);
+        animSpeed.push_back(clipTiming(c).speed * TICK_DT);
+        life.push_back(1);
+        return i;
+    }
+
+    // Removes every entity whose life flag is clear in one forward pass and
+    // hands their slots back to the free list
+    void compact() {
+        compactWith([](size_t, size_t) {});
+    }
+
+    // Switches entity i to another clip, restarting it if it changed
+    void play(size_t i, ClipId c) {
+        if (clip[i] == c) return;
+        clip[i] = c;
+        frame[i] = 0;
+        animSpeed[i] = clipTiming(c).speed * TICK_DT;
+    }
+
+    EntityHandle handle(size_t i) const {
+        return {kind, slots[i], generations[slots[i]]};
+    }
+
+    // Dense index of a handle, or -1 once its entity has been removed
+    int find(EntityHandle h) const {
+        if (h.kind != kind || h.slot >= generations.size() ||
+            generations[h.slot] != h.generation) {
+            return -1;
+        }
+        return static_cast<int>(denseIndex[h.slot]);
+    }
+
+    // Gives the entities written straight into the columns (by a save-state
+    // load) fresh slots, as if they had been add()ed to an empty pool.
+    // Handles from before stop resolving.
+    void rebuildSlots() {
+        size_t n = size();
+        for (uint32_t& g : generations) g++;
+        while (generations.size() < n) {
+            generations.push_back(0);
+            denseIndex.push_back(0);
+        }
+        slots.resize(n);
+        freeSlots.clear();
+        for (size_t s = generations.size(); s-- > n;) freeSlots.push_back(static_cast<uint32_t>(s));
+        for (size_t i = 0; i < n; i++) {
+            slots[i] = static_cast<uint32_t>(i);
+            denseIndex[i] = static_cast<uint32_t>(i);
+        }
+    }
+
+protected:
+    // compact() for kinds with extra columns: moveExtra(from, to) moves
+    // their own state along, and they shrink their columns to size() after
+    template <typename MoveExtra>
+    void compactWith(MoveExtra&& moveExtra) {
+        size_t n = size();
+        size_t kept = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (!life[i]) {
+                generations[slots[i]]++;
+                freeSlots.push_back(slots[i]);
+                continue;
+            }
+            if (kept != i) {
+                slots[kept] = slots[i];
+                denseIndex[slots[kept]] = static_cast<uint32_t>(kept);
+                x[kept] = x[i];
+                y[kept] = y[i];
+                dx[kept] = dx[i];
+                dy[kept] = dy[i];
+                R[kept] = R[i];
+                angle[kept] = angle[i];
+                clip[kept] = clip[i];
+                frame[kept] = frame[i];
+                animSpeed[kept] = animSpeed[i];
+                life[kept] = life[i];
+                moveExtra(i, kept);
+            }
+            kept++;
+        }
+        if (kept == n) return;
+
+        slots.resize(kept);
+        x.resize(kept);
+        y.resize(kept);
+        dx.resize(kept);
+        dy.resize(kept);
+        R.resize(kept);
+        angle.resize(kept);
+        clip.resize(kept);
+        frame.resize(kept);
+        animSpeed.resize(kept);
+        life.resize(kept);
+    }
+
+private:
+    int growthCount = 0;
+    std::vector<uint32_t> slots;       // dense index -> slot
+    std::vector<uint32_t> denseIndex;  // slot -> dense index
+    std::vector<uint32_t> generations; // slot -> generation
+    std::vector<uint32_t> freeSlots;
+};
+
+// Kinds with extra per-entity state add their own columns on top
+
+class PlayerArrays : public EntityArrays {
+public:
+    std::vector<uint8_t> thrust;
+
+    PlayerArrays() : EntityArrays(EntityKind::Player) {}
+
+    void reserve(size_t capacity) {
+        EntityArrays::reserve(capacity);
+        thrust.reserve(capacity);
+    }
+
+    size_t add(ClipId c, float X, float Y, float Angle, float radius) {
+        thrust.push_back(0);
+        return EntityArrays::add(c, X, Y, Angle, radius);
+    }
+
+    void compact() {
+        compactWith([&](size_t from, size_t to) { thrust[to] = thrust[from]; });
+        thrust.resize(size());
+    }
+};
+
+class BossArrays : public EntityArrays {
+public:
+    std::vector<int> health;
+    std::vector<uint8_t> spawnChildren;
+
+    BossArrays() : EntityArrays(EntityKind::Boss) {}
+
+    void reserve(size_t capacity) {
+        EntityArrays::reserve(capacity);
+        health.reserve(capacity);
+        spawnChildren.reserve(capacity);
+    }
+
+    size_t add(ClipId c, float X, float Y, float Angle, float radius) {
+        health.push_back(BOSS_MAX_HEALTH);
+        spawnChildren.push_back(1);
+        return EntityArrays::add(c, X, Y, Angle, radius);
+    }
+
+    void compact() {
+        compactWith([&](size_t from, size_t to) {
+            health[to] = health[from];
+            spawnChildren[to] = spawnChildren[from];
+        });
+        health.resize(size());
+        spawnChildren.resize(size());
+    }
+};
+
+class EffectArrays : public EntityArrays {
+public:
+    std::vector<float> currentSize;
+    std::vector<int> damageDealt;
+
+    EffectArrays() : EntityArrays(EntityKind::ExplosionEffect) {}
+
+    void reserve(size_t capacity) {
+        EntityArrays::reserve(capacity);
+        currentSize.reserve(capacity);
+        damageDealt.reserve(capacity);
+    }
+
+    size_t add(ClipId c, float X, float Y, float Angle, float radius) {
+        currentSize.push_back(0);
+        damageDealt.push_back(0);
+        return EntityArrays::add(c, X, Y, Angle, radius);
+    }
+
+    void compact() {
+        compactWith([&](size_t from, size_t to) {
+            currentSize[to] = currentSize[from];
+            damageDealt[to] = damageDealt[from];
+        });
+        currentSize.resize(size());
+        damageDealt.resize(size());
+    }
+};
+
+inline bool isCollide(const EntityArrays& a, size_t i, const EntityArrays& b, size_t j) {
+    return (b.x[j] - a.x[i]) * (b.x[j] - a.x[i]) +
+           (b.y[j] - a.y[i]) * (b.y[j] - a.y[i]) <
+           (a.R[i] + b.R[j]) * (a.R[i] + b.R[j]);
+}
+
+// Phases of World::step(), in the order they run
+enum class Phase : unsigned char {
+    Input,
+    Collide,
+    Spawn,
+    Commit,
+    Update,
+    Count
+};
+
+constexpr int PHASE_COUNT = static_cast<int>(Phase::Count);
+
+inline const char* phaseName(Phase phase) {
+    static const char* const names[PHASE_COUNT] = {"input", "collide", "spawn", "commit", "update"};
+    return names[static_cast<int>(phase)];
+}
+
+// Sound cues raised by the simulation. What each one sounds like is up to
+// the audio side.
+enum class SoundId : unsigned char {
+    Shot,
+    HomingShot,
+    Count
+};
+
+constexpr int SOUND_COUNT = static_cast<int>(SoundId::Count);
+
+using SoundQueue = SpscQueue<SoundId, 64>;
+
+// Something that broke apart this tick, for the renderer to throw debris
+// from. Velocity is per second.
+struct DebrisBurst {
+    float x, y;
+    float dx, dy;
+    float radius;
+};
+
+using DebrisQueue = SpscQueue<DebrisBurst, 1024>;
+
+// An entity waiting to be added to the world. Anything random about it is
+// rolled when the command is made, so the random sequence does not depend
+// on when the command is applied.
+struct SpawnCommand {
+    EntityKind kind;
+    ClipId clip;
+    float x, y, angle, radius;
+    float dx = 0, dy = 0;
+};
+
+// Player controls for one tick, already decoupled from any input device
+struct Input {
+    bool turnLeft = false;
+    bool turnRight = false;
+    bool thrust = false;
+    bool fire = false;
+    bool fireHoming = false;
+};
+
+struct StateHash {
+    uint64_t value = 0xCBF29CE484222325ull;
+
+    void add(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            value ^= bytes[i];
+            value *= 0x100000001B3ull;
+        }
+    }
+
+    template <typename T>
+    void add(const std::vector<T>& column) {
+        add(column.data(), column.size() * sizeof(T));
+    }
+};
+
+class World {
+public:
+    PlayerArrays players;
+    EntityArrays asteroids{EntityKind::Asteroid};
+    BossArrays bosses;
+    EntityArrays bullets{EntityKind::Bullet};
+    EntityArrays homing{EntityKind::HomingBullet};
+    EntityArrays explosions{EntityKind::Explosion};
+    EffectArrays effects;
+
+    EntityHandle player;
+
+    // Game state
+    bool bossSpawned = false;
+    int asteroidsShotDirectly = 0;
+    int asteroidsDestroyedInExplosions = 0;
+    int maxAsteroidsDestroyed = 0;
+    int activeBossCount = 0;
+    float shootCooldown = 0;
+    float homingShootCooldown = 0;
+
+    // Rounds ended by a crash and the score of the latest one, for whoever
+    // keeps score outside the world. They do not affect play, so they are
+    // neither hashed nor saved.
+    int roundsEnded = 0;
+    int lastRoundScore = 0;
+
+    // Every random decision of the game. Seed it before reset() to replay
+    // a game.
+    Rng rng;
+
+    // Optional queue for sound cues, emptied by whoever plays them. Cues
+    // that do not fit are dropped; the simulation never waits on audio.
+    SoundQueue* sounds = nullptr;
+
+    // Optional queue for debris bursts, like sounds: purely cosmetic, and
+    // bursts that do not fit are dropped
+    DebrisQueue* debris = nullptr;
+
+    // Optional thread pool for the heavy loops of step(). Work done on it
+    // only reads shared state or writes its own entities; everything else
+    // is collected per chunk and applied in order afterwards, so the game
+    // plays out the same with any number of threads.
+    JobSystem* jobs = nullptr;
+
+    World() {
+        players.reserve(PLAYER_CAPACITY);
+        asteroids.reserve(ASTEROID_CAPACITY);
+        bosses.reserve(BOSS_CAPACITY);
+        bullets.reserve(BULLET_CAPACITY);
+        homing.reserve(HOMING_BULLET_CAPACITY);
+        explosions.reserve(EXPLOSION_CAPACITY);
+        effects.reserve(EXPLOSION_EFFECT_CAPACITY);
+        targets.reserve(ASTEROID_CAPACITY + BOSS_CAPACITY);
+        shooters.reserve(PLAYER_CAPACITY + BULLET_CAPACITY + HOMING_BULLET_CAPACITY);
+        rocks.reserve(ASTEROID_CAPACITY + BOSS_CAPACITY);
+        pendingSpawns.reserve(EXPLOSION_CAPACITY);
+    }
+
+    int score() const {
+        return asteroidsShotDirectly + asteroidsDestroyedInExplosions;
+    }
+
+    // Starts a new round. The high score survives.
+    void reset() {
+        clear();
+        bossSpawned = false;
+        asteroidsShotDirectly = 0;
+        asteroidsDestroyedInExplosions = 0;
+        activeBossCount = 0;
+        shootCooldown = 0;
+        homingShootCooldown = 0;
+        spawnInitialAsteroids();
+        spawnPlayer(ClipId::Player, W/2, H/2);
+    }
+
+    // Advances the game by one fixed tick of TICK_DT seconds. Only input and
+    // rng feed into it, so the same seed and inputs replay the same game.
+    // The entity arrays keep their layout until the commit phase: spawns
+    // requested before it are queued, kills only clear life flags, and
+    // commit() applies both in one batch.
+    void step(const Input& input) {
+        step(input, [](Phase, auto&& run) { run(); });
+    }
+
+    // Same as step(), but hands every phase to wrap(phase, run), which must
+    // call run() exactly once. Lets benchmarks and profilers time the phases
+    // without the simulation knowing about clocks.
+    template <typename Wrap>
+    void step(const Input& input, Wrap&& wrap) {
+        deferSpawns = true;
+        wrap(Phase::Input, [&] { applyInput(input); });
+        wrap(Phase::Collide, [&] { collide(); });
+        wrap(Phase::Spawn, [&] { spawnRandom(); });
+        wrap(Phase::Commit, [&] { commit(); });
+        deferSpawns = false;
+        wrap(Phase::Update, [&] { update(); });
+    }
+
+    void spawnInitialAsteroids() {
+        for (int i = 0; i < INITIAL_ASTEROIDS; i++) {
+            float x = rng.below(W);
+            float y = rng.below(H);
+            spawnAsteroid(ClipId::Rock, x, y, rng.below(360), 25);
+        }
+    }
+
+    void spawnBossAsteroid() {
+        float x = rng.below(W-200) + 100;
+        float y = rng.below(H-200) + 100;
+        spawnBoss(ClipId::BossRock, x, y, rng.below(360));
+        activeBossCount++;
+        bossSpawned = true;
+    }
+
+    // Heap allocations made by spawning since startup. Stays at zero as long
+    // as no pool outgrows its reserved capacity.
+    int poolGrowths() {
+        int total = 0;
+        forEachKind([&](const EntityArrays& arr) { total += arr.growths(); });
+        return total;
+    }
+
+    // FNV-1a over everything that decides how the game goes on: the entity
+    // columns, the game state and the generator. Worlds with equal hashes
+    // play on identically, so replays compare these. The high score is left
+    // out: it carries over between rounds without changing how one plays.
+    uint64_t stateHash() {
+        StateHash h;
+        forEachKind([&](const EntityArrays& arr) {
+            h.add(arr.x);
+            h.add(arr.y);
+            h.add(arr.dx);
+            h.add(arr.dy);
+            h.add(arr.R);
+            h.add(arr.angle);
+            h.add(arr.clip);
+            h.add(arr.frame);
+            h.add(arr.life);
+        });
+        h.add(players.thrust);
+        h.add(bosses.health);
+        h.add(bosses.spawnChildren);
+        h.add(effects.currentSize);
+        h.add(effects.damageDealt);
+        int counters[] = {bossSpawned, asteroidsShotDirectly, asteroidsDestroyedInExplosions, activeBossCount};
+        float cooldowns[] = {shootCooldown, homingShootCooldown};
+        uint64_t generator = rng.state();
+        h.add(counters, sizeof counters);
+        h.add(cooldowns, sizeof cooldowns);
+        h.add(&generator, sizeof generator);
+        return h.value;
+    }
+
+    EntityArrays& of(EntityKind k) {
+        switch (k) {
+            case EntityKind::Player: return players;
+            case EntityKind::Asteroid: return asteroids;
+            case EntityKind::Boss: return bosses;
+            case EntityKind::Bullet: return bullets;
+            case EntityKind::HomingBullet: return homing;
+            case EntityKind::Explosion: return explosions;
+            default: return effects;
+        }
+    }
+
+    // Visits every kind's arrays with their concrete type, in draw order
+    template <typename F>
+    void forEachKind(F&& f) {
+        f(asteroids);
+        f(bosses);
+        f(players);
+        f(bullets);
+        f(homing);
+        f(explosions);
+        f(effects);
+    }
+
+    // Spawning. Outside step() (setup, reset) entities are added at once;
+    // inside it they are queued for the commit phase.
+    void spawn(const SpawnCommand& command) {
+        if (deferSpawns) {
+            pendingSpawns.push_back(command);
+        } else {
+            apply(command);
+        }
+    }
+
+    void spawnPlayer(ClipId c, float x, float y) {
+        spawn({EntityKind::Player, c, x, y, 0, 20});
+    }
+
+    void spawnAsteroid(ClipId c, float x, float y, float angle, float radius) {
+        spawn(asteroidCommand(c, x, y, angle, radius));
+    }
+
+    void spawnBoss(ClipId c, float x, float y, float angle) {
+        SpawnCommand boss{EntityKind::Boss, c, x, y, angle, 80};
+        boss.dx = (rng.below(5) - 2) * BOSS_SPEED_STEP;
+        boss.dy = (rng.below(5) - 2) * BOSS_SPEED_STEP;
+        spawn(boss);
+    }
+
+    void spawnBullet(ClipId c, float x, float y, float angle) {
+        SpawnCommand bullet{EntityKind::Bullet, c, x, y, angle, 10};
+        // Regular bullets never turn, so their velocity is fixed here
+        bullet.dx = cos(angle * DEGTORAD) * BULLET_SPEED;
+        bullet.dy = sin(angle * DEGTORAD) * BULLET_SPEED;
+        spawn(bullet);
+    }
+
+    void spawnHomingBullet(ClipId c, float x, float y, float angle) {
+        spawn({EntityKind::HomingBullet, c, x, y, angle, 10});
+    }
+
+    void spawnExplosion(ClipId c, float x, float y) {
+        spawn({EntityKind::Explosion, c, x, y, 0, 1});
+    }
+
+    void spawnExplosionEffect(float x, float y) {
+        spawn({EntityKind::ExplosionEffect, ClipId::None, x, y, 0, 1});
+    }
+
+    // Advance every entity by one tick
+    void update() {
+        updatePlayers();
+        updateAsteroids();
+        updateBosses();
+        if (homing.size() > 0 || effects.size() > 0) indexRocks();
+        updateBullets();
+        updateHomingBullets();
+        markFinishedExplosions();
+        updateExplosionEffects();
+        advanceAnimations();
+    }
+
+    // Compacts away dead entities (and explosions whose animation ended)
+    void removeDead() {
+        markFinishedExplosions();
+        forEachKind([](auto& arr) { arr.compact(); });
+    }
+
+    void clear() {
+        forEachKind([](auto& arr) {
+            std::fill(arr.life.begin(), arr.life.end(), 0);
+            arr.compact();
+        });
+        pendingSpawns.clear();
+        player = EntityHandle();
+    }
+
+    // Calls f(EntityRef) for every live rock of the kinds in kindMask whose
+    // circle overlaps the circle of the given radius around (x, y). Backed
+    // by the rock index, so only valid inside update() once it is built.
+    template <typename F>
+    void forEachRockTouching(float x, float y, float radius, unsigned kindMask, F&& f) {
+        rockIndex.forEachWithin(x, y, radius + maxRockRadius, [&](int r, float distSq) {
+            EntityRef ref = rocks[r];
+            if (!kindIn(ref.kind, kindMask)) return;
+            const EntityArrays& arr = of(ref.kind);
+            float reach = radius + arr.R[ref.index];
+            if (arr.life[ref.index] && distSq < reach * reach) f(ref);
+        });
+    }
+
+private:
+    std::vector<SpawnCommand> pendingSpawns;
+    bool deferSpawns = false;
+
+    SpawnCommand asteroidCommand(ClipId c, float x, float y, float angle, float radius) {
+        SpawnCommand rock{EntityKind::Asteroid, c, x, y, angle, radius};
+        rock.dx = (rng.below(8) - 4) * ASTEROID_SPEED_STEP;
+        rock.dy = (rng.below(8) - 4) * ASTEROID_SPEED_STEP;
+        return rock;
+    }
+
+    void apply(const SpawnCommand& command) {
+        forEachKind([&](auto& arr) {
+            if (arr.kind != command.kind) return;
+            size_t i = arr.add(command.clip, command.x, command.y, command.angle, command.radius);
+            arr.dx[i] = command.dx;
+            arr.dy[i] = command.dy;
+            if (command.kind == EntityKind::Player) player = arr.handle(i);
+        });
+    }
+
+    void cue(SoundId id) {
+        if (sounds) sounds->push(id);
+    }
+
+    void burst(const EntityArrays& arr, size_t i) {
+        if (debris) debris->push({arr.x[i], arr.y[i], arr.dx[i], arr.dy[i], arr.R[i]});
+    }
+
+    void applyInput(const Input& input) {
+        shootCooldown -= TICK_DT;
+        homingShootCooldown -= TICK_DT;
+
+        int p = players.find(player);
+        if (p < 0) return;
+
+        if (input.fireHoming && homingShootCooldown <= 0) {
+            spawnHomingBullet(ClipId::HomingBullet, players.x[p], players.y[p], players.angle[p]);
+            homingShootCooldown = HOMING_SHOOT_COOLDOWN;
+            cue(SoundId::HomingShot);
+        }
+        if (input.turnRight) players.angle[p] += PLAYER_TURN_SPEED * TICK_DT;
+        if (input.turnLeft) players.angle[p] -= PLAYER_TURN_SPEED * TICK_DT;
+        players.thrust[p] = input.thrust;
+
+        // Continuous firing while fire is held
+        if (input.fire && shootCooldown <= 0) {
+            spawnBullet(ClipId::Bullet, players.x[p], players.y[p], players.angle[p]);
+            shootCooldown = SHOOT_COOLDOWN;
+            cue(SoundId::Shot);
+        }
+    }
+
+    // Applies the tick's structural changes in one batch: dead entities are
+    // compacted away first, then queued spawns land in the order they were
+    // requested
+    void commit() {
+        int p = players.find(player);
+        if (p >= 0) {
+            players.play(p, players.thrust[p] ? ClipId::PlayerGo : ClipId::Player);
+        }
+        for (size_t i = 0; i < effects.size(); i++) {
+            if (!effects.life[i]) {
+                asteroidsDestroyedInExplosions += effects.damageDealt[i];
+            }
+        }
+        removeDead();
+
+        for (const SpawnCommand& command : pendingSpawns) apply(command);
+        pendingSpawns.clear();
+    }
+
+    void spawnRandom() {
+        if (score() >= BOSS_TRIGGER_SCORE &&
+            activeBossCount < MAX_BOSS_ASTEROIDS &&
+            rng.chance(BOSS_SPAWN_RATE * TICK_DT)) {
+            spawnBossAsteroid();
+        }
+        else if (!bossSpawned && rng.chance(ASTEROID_SPAWN_RATE * TICK_DT)) {
+            float y = rng.below(H);
+            spawnAsteroid(ClipId::Rock, 0, y, rng.below(360), 25);
+        }
+    }
+
+    // Collision responses, indexed by the kinds of the two entities. Each pair
+    // is registered in one orientation only; dispatchCollision() swaps the
+    // arguments when needed. A response returns true if it reset the world.
+    using CollisionResponse = bool (World::*)(EntityRef a, EntityRef b);
+    struct ResponseTable {
+        CollisionResponse at[KIND_COUNT][KIND_COUNT] = {};
+
+        ResponseTable() {
+            set(EntityKind::Player, EntityKind::Asteroid, &World::onPlayerHitRock);
+            set(EntityKind::Player, EntityKind::Boss, &World::onPlayerHitRock);
+            set(EntityKind::Boss, EntityKind::Bullet, &World::onBulletHitBoss);
+            set(EntityKind::Boss, EntityKind::HomingBullet, &World::onBulletHitBoss);
+            set(EntityKind::Asteroid, EntityKind::Bullet, &World::onBulletHitAsteroid);
+            set(EntityKind::Asteroid, EntityKind::HomingBullet, &World::onBulletHitAsteroid);
+        }
+
+        void set(EntityKind a, EntityKind b, CollisionResponse response) {
+            at[static_cast<int>(a)][static_cast<int>(b)] = response;
+        }
+    };
+
+    static const ResponseTable& collisionResponses() {
+        static const ResponseTable table;
+        return table;
+    }
+
+    // Chunk sizes for forEachChunk(), large enough to outweigh scheduling
+    static constexpr size_t INTEGRATE_GRAIN = 4096;
+    static constexpr size_t SHOOTER_GRAIN = 64;
+    static constexpr size_t HOMING_GRAIN = 4;
+    static constexpr size_t EFFECT_GRAIN = 1;
+
+    struct Hit {
+        EntityRef self;
+        int target;
+    };
+
+    struct EffectKill {
+        uint32_t effect;
+        uint32_t asteroid;
+    };
+
+    // Collision broadphase over the rocks, rebuilt every tick
+    CollisionGrid collisionGrid{W, H, GRID_CELL_SIZE};
+    std::vector<EntityRef> targets;
+    std::vector<EntityRef> shooters;
+    ChunkBuffers<Hit> hits;
+    ChunkBuffers<EffectKill> effectKills;
+
+    // Only rocks go into the grid; nothing happens when two rocks meet.
+    // The player and each bullet then test their circle against the rocks
+    // of every cell they overlap, eight candidates per overlapMask8(). The
+    // tests run in parallel and only record hits; the responses run after,
+    // in shooter order.
+    void collide() {
+        targets.clear();
+        collisionGrid.clear();
+        auto addTargets = [&](const EntityArrays& arr) {
+            for (size_t i = 0; i < arr.size(); i++) {
+                if (!arr.life[i]) continue;
+                targets.push_back({arr.kind, static_cast<uint32_t>(i)});
+                collisionGrid.insert(arr.x[i], arr.y[i], arr.R[i]);
+            }
+        };
+        addTargets(asteroids);
+        addTargets(bosses);
+        collisionGrid.build();
+
+        shooters.clear();
+        auto addShooters = [&](const EntityArrays& arr) {
+            for (size_t i = 0; i < arr.size(); i++) {
+                if (arr.life[i]) shooters.push_back({arr.kind, static_cast<uint32_t>(i)});
+            }
+        };
+        addShooters(players);
+        addShooters(bullets);
+        addShooters(homing);
+
+        hits.reset(chunkCount(jobs, shooters.size(), SHOOTER_GRAIN));
+        forEachChunk(jobs, shooters.size(), SHOOTER_GRAIN, [&](size_t chunk, size_t begin, size_t end) {
+            std::vector<Hit>& out = hits[chunk];
+            for (size_t s = begin; s < end; s++) {
+                EntityRef self = shooters[s];
+                const EntityArrays& arr = of(self.kind);
+                float x = arr.x[self.index], y = arr.y[self.index], r = arr.R[self.index];
+                size_t first = out.size();
+                collisionGrid.forEachCellRun(x, y, r, [&](const int* items, const float* xs, const float* ys,
+                                                          const float* rs, int count) {
+                    for (int k = 0; k < count; k += 8) {
+                        unsigned mask = overlapMask8(x, y, r, xs + k, ys + k, rs + k);
+                        if (count - k < 8) mask &= (1u << (count - k)) - 1;
+                        for (; mask; mask &= mask - 1) {
+                            int t = items[k + lowestBit(mask)];
+                            // Rocks spanning several cells show up once per cell
+                            auto seen = [&](const Hit& h) { return h.target == t; };
+                            if (std::none_of(out.begin() + first, out.end(), seen)) out.push_back({self, t});
+                        }
+                    }
+                });
+            }
+        });
+
+        bool worldReset = false;
+        hits.forEach([&](const Hit& hit) {
+            // The world was reset under us, remaining hits are stale
+            if (!worldReset) worldReset = dispatchCollision(hit.self, targets[hit.target]);
+        });
+    }
+
+    // Live asteroids and bosses by position, rebuilt in update() once the
+    // rocks have moved. Rocks can still die later in update(), but nothing
+    // is compacted before removeDead(), so the refs stay valid meanwhile.
+    PointGrid rockIndex{W, H, GRID_CELL_SIZE};
+    std::vector<EntityRef> rocks;
+    float maxRockRadius = 0;
+
+    void indexRocks() {
+        rocks.clear();
+        rockIndex.clear();
+        maxRockRadius = 0;
+        auto add = [&](const EntityArrays& arr) {
+            for (size_t i = 0; i < arr.size(); i++) {
+                if (!arr.life[i]) continue;
+                rocks.push_back({arr.kind, static_cast<uint32_t>(i)});
+                rockIndex.insert(arr.x[i], arr.y[i]);
+                maxRockRadius = std::max(maxRockRadius, arr.R[i]);
+            }
+        };
+        add(asteroids);
+        add(bosses);
+        rockIndex.build();
+    }
+
+    // Runs the response for two overlapping entities, if their kinds have
+    // one. Returns true if the response reset the world.
+    bool dispatchCollision(EntityRef a, EntityRef b) {
+        int ka = static_cast<int>(a.kind);
+        int kb = static_cast<int>(b.kind);
+        CollisionResponse response = collisionResponses().at[ka][kb];
+        if (!response) {
+            response = collisionResponses().at[kb][ka];
+            if (!response) return false;
+            std::swap(a, b);
+        }
+
+        // An earlier pair this tick may already have destroyed one of them
+        if (!of(a.kind).life[a.index] || !of(b.kind).life[b.index]) return false;
+        return (this->*response)(a, b);
+    }
+
+    static int bulletDamage(EntityKind bulletKind) {
+        return bulletKind == EntityKind::HomingBullet ? HOMING_BULLET_DAMAGE : REGULAR_BULLET_DAMAGE;
+    }
+
+    bool onPlayerHitRock(EntityRef ship, EntityRef rock) {
+        size_t p = ship.index;
+
+        of(rock.kind).life[rock.index] = 0;
+        burst(of(rock.kind), rock.index);
+        burst(players, p);
+        if (rock.kind == EntityKind::Boss) {
+            bosses.spawnChildren[rock.index] = 0;
+        }
+
+        maxAsteroidsDestroyed = std::max(maxAsteroidsDestroyed, score());
+        lastRoundScore = score();
+        roundsEnded++;
+
+        // Reset only current score, keep max
+        asteroidsShotDirectly = 0;
+        asteroidsDestroyedInExplosions = 0;
+
+        // Clear all asteroids and bullets, including ones queued this tick
+        // (removed in the commit phase)
+        forEachKind([](auto& arr) {
+            if (kindIn(arr.kind, ROCK_KINDS | BULLET_KINDS)) {
+                std::fill(arr.life.begin(), arr.life.end(), 0);
+            }
+        });
+        pendingSpawns.erase(std::remove_if(pendingSpawns.begin(), pendingSpawns.end(),
+                                           [](const SpawnCommand& command) {
+                                               return kindIn(command.kind, ROCK_KINDS | BULLET_KINDS);
+                                           }),
+                            pendingSpawns.end());
+        activeBossCount = 0;
+
+        // Respawn initial asteroids
+        spawnInitialAsteroids();
+
+        // Create explosion effect
+        ClipId blast = rock.kind == EntityKind::Boss ? ClipId::BossExplosion : ClipId::ExplosionShip;
+        spawnExplosion(blast, players.x[p], players.y[p]);
+
+        // Reset player
+        players.x[p] = W/2;
+        players.y[p] = H/2;
+        players.angle[p] = 0;
+        players.dx[p] = 0;
+        players.dy[p] = 0;
+        players.play(p, ClipId::Player);
+        return true;
+    }
+
+    bool onBulletHitBoss(EntityRef boss, EntityRef bullet) {
+        EntityArrays& shots = of(bullet.kind);
+        size_t b = boss.index;
+        size_t s = bullet.index;
+
+        shots.life[s] = 0;
+        bosses.health[b] -= bulletDamage(bullet.kind);
+
+        ClipId hit = bullet.kind == EntityKind::HomingBullet ? ClipId::Explosion : ClipId::ExplosionShip;
+        spawnExplosion(hit, shots.x[s], shots.y[s]);
+
+        if (bosses.health[b] <= 0) {
+            bosses.life[b] = 0;
+            burst(bosses, b);
+            activeBossCount--;
+            spawnExplosion(ClipId::BossExplosion, bosses.x[b], bosses.y[b]);
+
+            // Spawn 8 regular asteroids when boss is destroyed
+            if (bosses.spawnChildren[b]) {
+                for (int i = 0; i < 8; i++) {
+                    SpawnCommand rock = asteroidCommand(ClipId::RockSmall, bosses.x[b], bosses.y[b], rng.below(360), 15);
+                    // Inherit some boss velocity
+                    rock.dx = bosses.dx[b] * 0.5f + (rng.below(4) - 2) * ASTEROID_SPEED_STEP;
+                    rock.dy = bosses.dy[b] * 0.5f + (rng.below(4) - 2) * ASTEROID_SPEED_STEP;
+                    spawn(rock);
+                }
+            }
+
+            bossSpawned = activeBossCount > 0;
+            asteroidsShotDirectly += 10;
+        }
+        return false;
+    }
+
+    bool onBulletHitAsteroid(EntityRef asteroid, EntityRef bullet) {
+        size_t a = asteroid.index;
+        float x = asteroids.x[a];
+        float y = asteroids.y[a];
+
+        asteroids.life[a] = 0;
+        burst(asteroids, a);
+        of(bullet.kind).life[bullet.index] = 0;
+        asteroidsShotDirectly++;
+
+        spawnExplosion(ClipId::Explosion, x, y);
+
+        // Homing missiles leave a growing blast behind
+        if (bullet.kind == EntityKind::HomingBullet) {
+            spawnExplosionEffect(x, y);
+        }
+
+        if (asteroids.R[a] != 15) {
+            for (int i = 0; i < 2; i++) {
+                spawnAsteroid(ClipId::RockSmall, x, y, rng.below(360), 15);
+            }
+        }
+        return false;
+    }
+
+    static void wrap(float& v, float max) {
+        if (v > max) v = 0;
+        if (v < 0) v = max;
+    }
+
+    void updatePlayers() {
+        size_t n = players.size();
+        float* x = players.x.data();
+        float* y = players.y.data();
+        float* dx = players.dx.data();
+        float* dy = players.dy.data();
+        const float* angle = players.angle.data();
+        const uint8_t* thrust = players.thrust.data();
+        const float drag = std::pow(PLAYER_DRAG, TICK_DT);
+
+        for (size_t i = 0; i < n; i++) {
+            if (thrust[i]) {
+                dx[i] += cos(angle[i] * DEGTORAD) * PLAYER_THRUST * TICK_DT;
+                dy[i] += sin(angle[i] * DEGTORAD) * PLAYER_THRUST * TICK_DT;
+            } else {
+                dx[i] *= drag;
+                dy[i] *= drag;
+            }
+
+            float speed = sqrt(dx[i] * dx[i] + dy[i] * dy[i]);
+            if (speed > PLAYER_MAX_SPEED) {
+                dx[i] *= PLAYER_MAX_SPEED / speed;
+                dy[i] *= PLAYER_MAX_SPEED / speed;
+            }
+
+            x[i] += dx[i] * TICK_DT;
+            y[i] += dy[i] * TICK_DT;
+            wrap(x[i], W);
+            wrap(y[i], H);
+        }
+    }
+
+    void updateAsteroids() {
+        forEachChunk(jobs, asteroids.size(), INTEGRATE_GRAIN, [&](size_t, size_t begin, size_t end) {
+            integrateWrapped(&asteroids.x[begin], &asteroids.y[begin], &asteroids.dx[begin], &asteroids.dy[begin],
+                             end - begin, TICK_DT, W, H);
+        });
+    }
+
+    void updateBosses() {
+        integrateWrapped(bosses.x.data(), bosses.y.data(), bosses.dx.data(), bosses.dy.data(),
+                         bosses.size(), BOSS_SPEED_SCALE * TICK_DT, W, H);
+    }
+
+    void updateBullets() {
+        forEachChunk(jobs, bullets.size(), INTEGRATE_GRAIN, [&](size_t, size_t begin, size_t end) {
+            integrateBounded(&bullets.x[begin], &bullets.y[begin], &bullets.dx[begin], &bullets.dy[begin],
+                             &bullets.life[begin], end - begin, TICK_DT, W, H);
+        });
+    }
+
+    void updateHomingBullets() {
+        forEachChunk(jobs, homing.size(), HOMING_GRAIN, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) steerHomingBullet(i);
+        });
+    }
+
+    void steerHomingBullet(size_t i) {
+        float& x = homing.x[i];
+        float& y = homing.y[i];
+
+        // Find closest target
+        int nearest = rockIndex.nearest(x, y, [&](int r) {
+            return of(rocks[r].kind).life[rocks[r].index] != 0;
+        });
+
+        // Adjust angle if target found
+        if (nearest >= 0) {
+            const EntityArrays& target = of(rocks[nearest].kind);
+            size_t t = rocks[nearest].index;
+            float targetAngle = atan2(target.y[t] - y, target.x[t] - x) / DEGTORAD;
+            float angleDiff = targetAngle - homing.angle[i];
+
+            while (angleDiff > 180) angleDiff -= 360;
+            while (angleDiff < -180) angleDiff += 360;
+
+            homing.angle[i] += angleDiff * std::min(1.f, HOMING_TURN_RATE * TICK_DT);
+        }
+
+        homing.dx[i] = cos(homing.angle[i] * DEGTORAD) * BULLET_SPEED;
+        homing.dy[i] = sin(homing.angle[i] * DEGTORAD) * BULLET_SPEED;
+        x += homing.dx[i] * TICK_DT;
+        y += homing.dy[i] * TICK_DT;
+
+        if (x > W || x < 0 || y > H || y < 0) homing.life[i] = 0;
+    }
+
+    void markFinishedExplosions() {
+        for (size_t i = 0; i < explosions.size(); i++) {
+            if (clipTiming(explosions.clip[i]).isEnd(explosions.frame[i], explosions.animSpeed[i])) {
+                explosions.life[i] = 0;
+            }
+        }
+    }
+
+    // Effects only collect the asteroids they touch in parallel. The kills
+    // are applied in effect order afterwards, so an asteroid caught by two
+    // blasts is still credited to the first one.
+    void updateExplosionEffects() {
+        effectKills.reset(chunkCount(jobs, effects.size(), EFFECT_GRAIN));
+        forEachChunk(jobs, effects.size(), EFFECT_GRAIN, [&](size_t chunk, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                if (effects.currentSize[i] < EXPLOSION_EFFECT_RADIUS) {
+                    effects.currentSize[i] += EXPLOSION_EFFECT_GROWTH * TICK_DT;
+                    float size = effects.currentSize[i];
+                    forEachRockTouching(effects.x[i], effects.y[i], size, kindBit(EntityKind::Asteroid),
+                                        [&](EntityRef rock) {
+                        effectKills[chunk].push_back({static_cast<uint32_t>(i), rock.index});
+                    });
+                } else {
+                    effects.life[i] = 0;
+                }
+            }
+        });
+
+        effectKills.forEach([&](const EffectKill& kill) {
+            if (!asteroids.life[kill.asteroid]) return;
+            asteroids.life[kill.asteroid] = 0;
+            burst(asteroids, kill.asteroid);
+            effects.damageDealt[kill.effect]++;
+        });
+    }
+
+    void advanceAnimations() {
+        forEachKind([&](auto& arr) {
+            forEachChunk(jobs, arr.size(), INTEGRATE_GRAIN, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    clipTiming(arr.clip[i]).advance(arr.frame[i], arr.animSpeed[i]);
+                }
+            });
+        });
+    }
+};
+
+#endif // WORLD_HPP